@@ -0,0 +1,31 @@
+#ifndef ADMIN_LOADTEST_H
+#define ADMIN_LOADTEST_H
+
+/* This generated file contains includes for project dependencies */
+#include <admin_loadtest/bake_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stand-in for the HTTP server of flecs.systems.civetweb. It serves the
+ * endpoints of an EcsHttpServer on the loopback interface, with one request per
+ * connection. Synchronous endpoints run on the main thread while the world
+ * progresses, other endpoints run on a pool of threads and lock the world.
+ * Only one server can run per process. */
+typedef struct LoadtestHttp {
+    ECS_DECLARE_ENTITY(LoadtestHttpProcess);
+} LoadtestHttp;
+
+void LoadtestHttpImport(
+    ecs_world_t *world,
+    int flags);
+
+#define LoadtestHttpImportHandles(handles) \
+    ECS_IMPORT_ENTITY(handles, LoadtestHttpProcess);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
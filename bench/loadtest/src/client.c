@@ -0,0 +1,287 @@
+#include <admin_loadtest.h>
+#include "client.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Same parameters as the world request of the dashboard (etc/js/app.js) */
+#define LOADTEST_WORLD_URL \
+    "world?component_limit=100&type_sort=systems&type_limit=100"
+
+/* The systems endpoint and a file are requested every N world requests */
+#define LOADTEST_SYSTEMS_EVERY (10)
+#define LOADTEST_FILES_EVERY (20)
+
+static
+const char *files[] = {
+    "index.html",
+    "js/app.js",
+    "css/style.css"
+};
+
+typedef struct loadtest_client_t {
+    loadtest_clients_t *clients;
+    ecs_os_thread_t thread;
+    loadtest_result_t results[LoadtestTargetCount];
+} loadtest_client_t;
+
+struct loadtest_clients_t {
+    uint16_t port;
+    uint32_t think_ms;
+    ecs_os_mutex_t lock;
+    bool quit;
+    uint32_t running;
+    uint32_t count;
+    loadtest_client_t *clients;
+};
+
+static
+const ecs_vector_params_t double_params = {
+    .element_size = sizeof(double)
+};
+
+static
+bool should_quit(
+    loadtest_clients_t *clients)
+{
+    ecs_os_mutex_lock(clients->lock);
+    bool result = clients->quit;
+    ecs_os_mutex_unlock(clients->lock);
+    return result;
+}
+
+/* Send a GET request and read the reply. Returns the status of the reply, or
+ * -1 if the request failed. */
+static
+int http_get(
+    uint16_t port,
+    const char *url,
+    uint64_t *bytes_out)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        close(fd);
+        return -1;
+    }
+
+    char request[512];
+    int len = snprintf(request, sizeof(request),
+        "GET /%s HTTP/1.1\r\n"
+        "Host: localhost:%u\r\n"
+        "Connection: close\r\n"
+        "\r\n", url, port);
+
+    if (send(fd, request, len, MSG_NOSIGNAL) != len) {
+        close(fd);
+        return -1;
+    }
+
+    /* Read until the server closes the connection. Only the status line is
+     * parsed, the rest of the reply is counted. */
+    char buf[16 * 1024];
+    uint64_t bytes = 0;
+    int status = -1;
+    ssize_t received;
+
+    while ((received = recv(fd, buf, sizeof(buf) - 1, 0)) != 0) {
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            status = -1;
+            break;
+        }
+
+        if (!bytes) {
+            buf[received] = '\0';
+            if (sscanf(buf, "HTTP/1.%*d %d", &status) != 1) {
+                status = -1;
+            }
+        }
+
+        bytes += received;
+    }
+
+    close(fd);
+
+    *bytes_out += bytes;
+
+    return status;
+}
+
+static
+void request(
+    loadtest_client_t *client,
+    loadtest_target_t target,
+    const char *url)
+{
+    loadtest_result_t *result = &client->results[target];
+
+    ecs_time_t start;
+    ecs_os_get_time(&start);
+
+    int status = http_get(client->clients->port, url, &result->bytes);
+
+    double latency = ecs_time_measure(&start) * 1000.0;
+
+    if (status == 503) {
+        result->shed ++;
+    } else if (status != 200) {
+        result->errors ++;
+    } else {
+        double *elem = ecs_vector_add(&result->latency, &double_params);
+        *elem = latency;
+    }
+}
+
+static
+void* client_thread(
+    void *arg)
+{
+    loadtest_client_t *client = arg;
+    loadtest_clients_t *clients = client->clients;
+    uint32_t iteration = 0;
+
+    while (!should_quit(clients)) {
+        request(client, LoadtestWorld, LOADTEST_WORLD_URL);
+
+        if (!(iteration % LOADTEST_SYSTEMS_EVERY)) {
+            request(client, LoadtestSystems, "systems");
+        }
+
+        /* Includes the first iteration, like a dashboard that is opened */
+        if (!(iteration % LOADTEST_FILES_EVERY)) {
+            uint32_t file = (iteration / LOADTEST_FILES_EVERY) %
+                (sizeof(files) / sizeof(files[0]));
+            request(client, LoadtestFiles, files[file]);
+        }
+
+        if (clients->think_ms) {
+            ecs_os_sleep(clients->think_ms / 1000,
+                (clients->think_ms % 1000) * 1000 * 1000);
+        }
+
+        iteration ++;
+    }
+
+    ecs_os_mutex_lock(clients->lock);
+    clients->running --;
+    ecs_os_mutex_unlock(clients->lock);
+
+    return NULL;
+}
+
+loadtest_clients_t* loadtest_clients_start(
+    uint16_t port,
+    uint32_t count,
+    uint32_t think_ms)
+{
+    loadtest_clients_t *result = ecs_os_calloc(1, sizeof(loadtest_clients_t));
+    result->port = port;
+    result->think_ms = think_ms;
+    result->lock = ecs_os_mutex_new();
+    result->count = count;
+    result->clients = ecs_os_calloc(count, sizeof(loadtest_client_t));
+
+    uint32_t i, t;
+    for (i = 0; i < count; i ++) {
+        loadtest_client_t *client = &result->clients[i];
+        client->clients = result;
+        for (t = 0; t < LoadtestTargetCount; t ++) {
+            client->results[t].latency = ecs_vector_new(&double_params, 0);
+        }
+    }
+
+    /* Start threads after all clients are initialized */
+    result->running = count;
+    for (i = 0; i < count; i ++) {
+        result->clients[i].thread =
+            ecs_os_thread_new(client_thread, &result->clients[i]);
+    }
+
+    return result;
+}
+
+void loadtest_clients_quit(
+    loadtest_clients_t *clients)
+{
+    ecs_os_mutex_lock(clients->lock);
+    clients->quit = true;
+    ecs_os_mutex_unlock(clients->lock);
+}
+
+uint32_t loadtest_clients_running(
+    loadtest_clients_t *clients)
+{
+    ecs_os_mutex_lock(clients->lock);
+    uint32_t result = clients->running;
+    ecs_os_mutex_unlock(clients->lock);
+    return result;
+}
+
+void loadtest_clients_stop(
+    loadtest_clients_t *clients,
+    loadtest_result_t *results)
+{
+    loadtest_clients_quit(clients);
+
+    uint32_t i, t;
+    for (i = 0; i < clients->count; i ++) {
+        ecs_os_thread_join(clients->clients[i].thread);
+    }
+
+    for (t = 0; t < LoadtestTargetCount; t ++) {
+        loadtest_result_t *result = &results[t];
+        result->latency = ecs_vector_new(&double_params, 0);
+        result->errors = 0;
+        result->shed = 0;
+        result->bytes = 0;
+
+        for (i = 0; i < clients->count; i ++) {
+            loadtest_result_t *r = &clients->clients[i].results[t];
+            double *latency = ecs_vector_first(r->latency);
+            uint32_t l, count = ecs_vector_count(r->latency);
+
+            for (l = 0; l < count; l ++) {
+                double *elem = ecs_vector_add(&result->latency, &double_params);
+                *elem = latency[l];
+            }
+
+            result->errors += r->errors;
+            result->shed += r->shed;
+            result->bytes += r->bytes;
+
+            ecs_vector_free(r->latency);
+        }
+    }
+
+    ecs_os_mutex_free(clients->lock);
+    ecs_os_free(clients->clients);
+    ecs_os_free(clients);
+}
+
+const char* loadtest_target_name(
+    loadtest_target_t target)
+{
+    switch(target) {
+    case LoadtestWorld: return "world";
+    case LoadtestSystems: return "systems";
+    case LoadtestFiles: return "files";
+    default: return "?";
+    }
+}
@@ -0,0 +1,45 @@
+#include <admin_loadtest.h>
+
+/* Simulated dashboard clients. Each client repeatedly requests the world
+ * statistics with the parameters of the dashboard, and regularly requests the
+ * systems endpoint and a static file. Every request uses a new connection. */
+
+typedef enum loadtest_target_t {
+    LoadtestWorld,
+    LoadtestSystems,
+    LoadtestFiles,
+    LoadtestTargetCount
+} loadtest_target_t;
+
+/* Requests of all clients to one target */
+typedef struct loadtest_result_t {
+    ecs_vector_t *latency;      /* Latency of successful requests in ms */
+    uint32_t errors;            /* Failed connections and error replies */
+    uint32_t shed;              /* 503 replies */
+    uint64_t bytes;             /* Bytes received */
+} loadtest_result_t;
+
+typedef struct loadtest_clients_t loadtest_clients_t;
+
+/* Start clients. Clients wait think_ms between requests to the world. */
+loadtest_clients_t* loadtest_clients_start(
+    uint16_t port,
+    uint32_t count,
+    uint32_t think_ms);
+
+/* Signal clients to stop after their current request */
+void loadtest_clients_quit(
+    loadtest_clients_t *clients);
+
+/* Number of clients that have not stopped yet */
+uint32_t loadtest_clients_running(
+    loadtest_clients_t *clients);
+
+/* Wait for clients to stop, and merge the results of all clients into results,
+ * which must have LoadtestTargetCount elements. Frees the clients. */
+void loadtest_clients_stop(
+    loadtest_clients_t *clients,
+    loadtest_result_t *results);
+
+const char* loadtest_target_name(
+    loadtest_target_t target);
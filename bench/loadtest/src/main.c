@@ -0,0 +1,344 @@
+#include <admin_loadtest.h>
+#include "client.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The load test runs a synthetic world with the admin, and measures how the
+ * admin behaves when many dashboards are connected. The world first runs
+ * without clients to measure its baseline frame time. Then the clients are
+ * started, and the frame time is measured again while they request statistics.
+ *
+ * When flecs.systems.civetweb is added to the dependencies of this project, the
+ * test runs against civetweb, unless --standin is passed. Otherwise it runs
+ * against the stand-in server of this project. */
+
+typedef struct loadtest_config_t {
+    uint16_t port;
+    uint32_t clients;
+    uint32_t duration;          /* Seconds that clients run */
+    uint32_t baseline;          /* Seconds that the world runs without clients */
+    uint32_t think_ms;          /* Time between world requests of a client */
+    uint32_t systems;
+    uint32_t entities;
+    float fps;
+    bool standin;
+} loadtest_config_t;
+
+typedef struct Position {
+    float x;
+    float y;
+} Position;
+
+typedef struct Velocity {
+    float x;
+    float y;
+} Velocity;
+
+static
+const ecs_vector_params_t double_params = {
+    .element_size = sizeof(double)
+};
+
+static
+void Move(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    ECS_COLUMN(rows, Velocity, v, 2);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x += v[i].x * rows->delta_time;
+        p[i].y += v[i].y * rows->delta_time;
+    }
+}
+
+static
+void usage(void) {
+    printf(
+        "Usage: admin_loadtest [options]\n"
+        "  --port <port>        port of the admin (default 9191)\n"
+        "  --clients <count>    number of dashboard clients (default 16)\n"
+        "  --duration <sec>     time that clients run (default 10)\n"
+        "  --baseline <sec>     time that the world runs alone (default 3)\n"
+        "  --think <ms>         time between requests of a client (default 0)\n"
+        "  --systems <count>    number of systems in the world (default 200)\n"
+        "  --entities <count>   number of entities in the world (default 10000)\n"
+        "  --fps <fps>          target frame rate of the world (default 60)\n"
+        "  --standin            use the stand-in server instead of civetweb\n");
+}
+
+static
+bool parse_args(
+    int argc,
+    char *argv[],
+    loadtest_config_t *config)
+{
+    int i;
+    for (i = 1; i < argc; i ++) {
+        const char *arg = argv[i];
+        const char *value = i < argc - 1 ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--standin")) {
+            config->standin = true;
+            continue;
+        }
+
+        if (!value) {
+            return false;
+        }
+
+        if (!strcmp(arg, "--port")) {
+            config->port = atoi(value);
+        } else if (!strcmp(arg, "--clients")) {
+            config->clients = atoi(value);
+        } else if (!strcmp(arg, "--duration")) {
+            config->duration = atoi(value);
+        } else if (!strcmp(arg, "--baseline")) {
+            config->baseline = atoi(value);
+        } else if (!strcmp(arg, "--think")) {
+            config->think_ms = atoi(value);
+        } else if (!strcmp(arg, "--systems")) {
+            config->systems = atoi(value);
+        } else if (!strcmp(arg, "--entities")) {
+            config->entities = atoi(value);
+        } else if (!strcmp(arg, "--fps")) {
+            config->fps = atof(value);
+        } else {
+            return false;
+        }
+
+        i ++;
+    }
+
+    return config->port && config->duration && config->fps > 0;
+}
+
+/* Create entities and systems, spread out over the phases of a frame */
+static
+void populate(
+    ecs_world_t *world,
+    loadtest_config_t *config)
+{
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    uint32_t i;
+    for (i = 0; i < config->entities; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+        ecs_set(world, e, Velocity, {i % 10, i % 7});
+    }
+
+    EcsSystemKind phases[] = {
+        EcsOnLoad, EcsPostLoad, EcsPreUpdate, EcsOnUpdate, EcsOnValidate,
+        EcsPostUpdate, EcsPreStore, EcsOnStore
+    };
+
+    for (i = 0; i < config->systems; i ++) {
+        /* System names are not copied, and live as long as the world */
+        char *name = ecs_os_malloc(32);
+        sprintf(name, "Move%u", i);
+        ecs_new_system(world, name, phases[i % 8], "Position, Velocity", Move);
+    }
+}
+
+/* Progress the world for the specified time, and store the time of each frame
+ * in ms. The world is paced here instead of with ecs_set_target_fps, so that
+ * the frame time does not include the time the world sleeps. */
+static
+void run_frames(
+    ecs_world_t *world,
+    float fps,
+    uint32_t seconds,
+    ecs_vector_t **frames)
+{
+    double period = 1.0 / fps;
+    double elapsed = 0;
+    ecs_time_t start;
+    ecs_os_get_time(&start);
+
+    while (elapsed < seconds) {
+        ecs_time_t t;
+        ecs_os_get_time(&t);
+        ecs_progress(world, 0);
+        double frame = ecs_time_measure(&t);
+
+        double *elem = ecs_vector_add(frames, &double_params);
+        *elem = frame * 1000.0;
+
+        if (frame < period) {
+            ecs_os_sleep(0, (period - frame) * 1000 * 1000 * 1000);
+        }
+
+        ecs_time_t now = start;
+        elapsed = ecs_time_measure(&now);
+    }
+}
+
+static
+int compare_double(
+    const void *p1,
+    const void *p2)
+{
+    double d1 = *(double*)p1;
+    double d2 = *(double*)p2;
+    return (d1 > d2) - (d1 < d2);
+}
+
+typedef struct loadtest_dist_t {
+    uint32_t count;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+} loadtest_dist_t;
+
+/* Sorts the samples */
+static
+loadtest_dist_t distribution(
+    ecs_vector_t *samples)
+{
+    loadtest_dist_t result = {0};
+    double *buffer = ecs_vector_first(samples);
+    uint32_t i, count = ecs_vector_count(samples);
+
+    if (!count) {
+        return result;
+    }
+
+    qsort(buffer, count, sizeof(double), compare_double);
+
+    double sum = 0;
+    for (i = 0; i < count; i ++) {
+        sum += buffer[i];
+    }
+
+    result.count = count;
+    result.mean = sum / count;
+    result.p50 = buffer[(count - 1) * 50 / 100];
+    result.p90 = buffer[(count - 1) * 90 / 100];
+    result.p99 = buffer[(count - 1) * 99 / 100];
+    result.max = buffer[count - 1];
+
+    return result;
+}
+
+static
+void report(
+    loadtest_config_t *config,
+    loadtest_result_t *results,
+    ecs_vector_t *baseline,
+    ecs_vector_t *load)
+{
+    printf("\n%u clients, %u systems, %u entities, %us (%s server)\n\n",
+        config->clients, config->systems, config->entities, config->duration,
+        config->standin ? "stand-in" : "civetweb");
+
+    printf("%-10s %9s %9s %9s %7s %6s %9s %9s %9s %9s\n",
+        "endpoint", "requests", "req/s", "MB/s", "errors", "shed",
+        "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+    uint32_t t, total = 0;
+    for (t = 0; t < LoadtestTargetCount; t ++) {
+        loadtest_result_t *r = &results[t];
+        loadtest_dist_t d = distribution(r->latency);
+        total += d.count;
+
+        printf("%-10s %9u %9.1f %9.2f %7u %6u %9.2f %9.2f %9.2f %9.2f\n",
+            loadtest_target_name(t), d.count,
+            (double)d.count / config->duration,
+            (double)r->bytes / config->duration / (1024 * 1024),
+            r->errors, r->shed, d.p50, d.p90, d.p99, d.max);
+    }
+
+    printf("%-10s %9u %9.1f\n", "total", total,
+        (double)total / config->duration);
+
+    loadtest_dist_t b = distribution(baseline);
+    loadtest_dist_t l = distribution(load);
+
+    printf("\n%-10s %9s %9s %9s %9s %9s\n",
+        "frame", "frames", "mean ms", "p50 ms", "p99 ms", "max ms");
+    printf("%-10s %9u %9.3f %9.3f %9.3f %9.3f\n", "baseline",
+        b.count, b.mean, b.p50, b.p99, b.max);
+    printf("%-10s %9u %9.3f %9.3f %9.3f %9.3f\n", "load",
+        l.count, l.mean, l.p50, l.p99, l.max);
+    printf("%-10s %9s %+9.3f %+9.3f %+9.3f %+9.3f\n", "impact", "",
+        l.mean - b.mean, l.p50 - b.p50, l.p99 - b.p99, l.max - b.max);
+}
+
+int main(int argc, char *argv[]) {
+    loadtest_config_t config = {
+        .port = 9191,
+        .clients = 16,
+        .duration = 10,
+        .baseline = 3,
+        .systems = 200,
+        .entities = 10000,
+        .fps = 60
+    };
+
+    if (!parse_args(argc, argv, &config)) {
+        usage();
+        return -1;
+    }
+
+#ifndef FLECS_SYSTEMS_CIVETWEB_H
+    config.standin = true;
+#endif
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_IMPORT(world, FlecsComponentsHttp, 0);
+
+#ifdef FLECS_SYSTEMS_CIVETWEB_H
+    if (!config.standin) {
+        ECS_IMPORT(world, FlecsSystemsCivetweb, 0);
+    } else
+#endif
+    {
+        ECS_IMPORT(world, LoadtestHttp, 0);
+    }
+
+    ECS_IMPORT(world, FlecsSystemsAdmin, 0);
+
+    populate(world, &config);
+
+    ecs_set(world, 0, EcsAdmin, {.port = config.port});
+
+    ecs_vector_t *baseline = ecs_vector_new(&double_params, 0);
+    ecs_vector_t *load = ecs_vector_new(&double_params, 0);
+
+    printf("running world without clients for %us\n", config.baseline);
+    run_frames(world, config.fps, config.baseline, &baseline);
+
+    printf("running world with %u clients for %us\n",
+        config.clients, config.duration);
+
+    loadtest_clients_t *clients = loadtest_clients_start(
+        config.port, config.clients, config.think_ms);
+
+    run_frames(world, config.fps, config.duration, &load);
+
+    /* Clients may wait for a synchronous request, which is only processed
+     * while the world progresses */
+    loadtest_clients_quit(clients);
+    while (loadtest_clients_running(clients)) {
+        ecs_progress(world, 0);
+    }
+
+    loadtest_result_t results[LoadtestTargetCount];
+    loadtest_clients_stop(clients, results);
+
+    report(&config, results, baseline, load);
+
+    uint32_t t;
+    for (t = 0; t < LoadtestTargetCount; t ++) {
+        ecs_vector_free(results[t].latency);
+    }
+
+    ecs_vector_free(baseline);
+    ecs_vector_free(load);
+
+    return ecs_fini(world);
+}
@@ -0,0 +1,580 @@
+#include <admin_loadtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Number of threads that handle connections */
+#define STANDIN_THREADS (8)
+
+/* Maximum number of accepted connections waiting for a thread */
+#define STANDIN_QUEUE_SIZE (256)
+
+/* Maximum size of the request line and headers */
+#define STANDIN_MAX_HEAD (8 * 1024)
+
+typedef struct standin_endpoint_t {
+    char *url;
+    ecs_entity_t entity;
+    EcsHttpEndpoint endpoint;
+} standin_endpoint_t;
+
+/* Request for a synchronous endpoint, which is processed on the main thread */
+typedef struct standin_sync_t {
+    standin_endpoint_t *endpoint;
+    EcsHttpRequest *request;
+    EcsHttpReply *reply;
+    bool result;
+    bool done;
+} standin_sync_t;
+
+typedef struct standin_server_t {
+    ecs_world_t *world;
+    ecs_entity_t entity;
+    int socket;
+
+    ecs_os_mutex_t lock;
+    ecs_os_cond_t queue_cond;   /* Signalled when a connection is accepted */
+    ecs_os_cond_t sync_cond;    /* Signalled when sync requests completed */
+
+    int queue[STANDIN_QUEUE_SIZE];
+    uint32_t queue_head;
+    uint32_t queue_count;
+
+    ecs_vector_t *endpoints;    /* standin_endpoint_t* */
+    ecs_vector_t *sync;         /* standin_sync_t* */
+
+    ecs_os_thread_t accept_thread;
+    ecs_os_thread_t threads[STANDIN_THREADS];
+} standin_server_t;
+
+static
+const ecs_vector_params_t ptr_params = {
+    .element_size = sizeof(void*)
+};
+
+/* Server of the process */
+static standin_server_t *standin;
+
+static
+char* standin_strdup(
+    const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char *result = ecs_os_malloc(len);
+    memcpy(result, str, len);
+    return result;
+}
+
+static
+bool send_all(
+    int fd,
+    const char *data,
+    size_t size)
+{
+    while (size) {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+static
+const char* status_text(
+    int status)
+{
+    switch(status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+static
+const char* content_type(
+    const char *file)
+{
+    const char *ext = file ? strrchr(file, '.') : NULL;
+    if (!ext) {
+        return "application/json";
+    } else if (!strcmp(ext, ".html")) {
+        return "text/html";
+    } else if (!strcmp(ext, ".js")) {
+        return "application/javascript";
+    } else if (!strcmp(ext, ".css")) {
+        return "text/css";
+    } else {
+        return "application/octet-stream";
+    }
+}
+
+static
+void send_head(
+    int fd,
+    int status,
+    const char *type,
+    size_t length,
+    const char *header)
+{
+    char head[1024];
+    int len = snprintf(head, sizeof(head),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %zu\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: close\r\n"
+        "%s\r\n",
+        status, status_text(status), type, length, header ? header : "");
+
+    if (len > 0 && (size_t)len < sizeof(head)) {
+        send_all(fd, head, len);
+    }
+}
+
+static
+void send_file(
+    int fd,
+    const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        send_head(fd, 404, "text/plain", 0, NULL);
+        return;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    send_head(fd, 200, content_type(path), size, NULL);
+
+    char buf[16 * 1024];
+    size_t read;
+    while ((read = fread(buf, 1, sizeof(buf), f))) {
+        if (!send_all(fd, buf, read)) {
+            break;
+        }
+    }
+
+    fclose(f);
+}
+
+/* Find endpoint with the longest url that matches the path. Endpoint urls match
+ * whole path elements, and the empty url matches any path. */
+static
+standin_endpoint_t* find_endpoint(
+    standin_server_t *server,
+    const char *path)
+{
+    standin_endpoint_t **buffer = ecs_vector_first(server->endpoints);
+    uint32_t i, count = ecs_vector_count(server->endpoints);
+    standin_endpoint_t *result = NULL;
+    size_t result_len = 0;
+
+    for (i = 0; i < count; i ++) {
+        const char *url = buffer[i]->url;
+        size_t len = strlen(url);
+
+        if (strncmp(url, path, len)) {
+            continue;
+        }
+
+        if (len && path[len] && path[len] != '/') {
+            continue;
+        }
+
+        if (!result || len > result_len) {
+            result = buffer[i];
+            result_len = len;
+        }
+    }
+
+    return result;
+}
+
+/* Run the action of a synchronous endpoint on the main thread */
+static
+bool run_sync(
+    standin_server_t *server,
+    standin_endpoint_t *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    standin_sync_t sync = {
+        .endpoint = endpoint,
+        .request = request,
+        .reply = reply
+    };
+
+    ecs_os_mutex_lock(server->lock);
+    standin_sync_t **elem = ecs_vector_add(&server->sync, &ptr_params);
+    *elem = &sync;
+    while (!sync.done) {
+        ecs_os_cond_wait(server->sync_cond, server->lock);
+    }
+    ecs_os_mutex_unlock(server->lock);
+
+    return sync.result;
+}
+
+/* Read request head. Returns the number of bytes read, or 0 if the request is
+ * too large or the connection was closed. */
+static
+size_t read_head(
+    int fd,
+    char *buf,
+    size_t size)
+{
+    size_t count = 0;
+
+    while (count < size - 1) {
+        ssize_t received = recv(fd, &buf[count], size - 1 - count, 0);
+        if (received <= 0) {
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+
+        count += received;
+        buf[count] = '\0';
+
+        if (strstr(buf, "\r\n\r\n")) {
+            return count;
+        }
+    }
+
+    return 0;
+}
+
+static
+void handle_connection(
+    standin_server_t *server,
+    int fd)
+{
+    char head[STANDIN_MAX_HEAD];
+    if (!read_head(fd, head, sizeof(head))) {
+        return;
+    }
+
+    /* Request line: <method> /<path>[?<params>] HTTP/1.x */
+    char *method = head;
+    char *target = strchr(method, ' ');
+    if (!target) {
+        send_head(fd, 400, "text/plain", 0, NULL);
+        return;
+    }
+    *target = '\0';
+    target ++;
+
+    char *end = strchr(target, ' ');
+    if (!end) {
+        send_head(fd, 400, "text/plain", 0, NULL);
+        return;
+    }
+    *end = '\0';
+
+    EcsHttpMethod http_method = EcsHttpMethodUnknown;
+    if (!strcmp(method, "GET")) {
+        http_method = EcsHttpGet;
+    } else if (!strcmp(method, "POST")) {
+        http_method = EcsHttpPost;
+    } else if (!strcmp(method, "PUT")) {
+        http_method = EcsHttpPut;
+    } else if (!strcmp(method, "DELETE")) {
+        http_method = EcsHttpDelete;
+    }
+
+    char *path = target;
+    if (path[0] == '/') {
+        path ++;
+    }
+
+    char *params = strchr(path, '?');
+    if (params) {
+        *params = '\0';
+        params ++;
+    } else {
+        params = "";
+    }
+
+    ecs_os_mutex_lock(server->lock);
+    standin_endpoint_t *endpoint = find_endpoint(server, path);
+    ecs_os_mutex_unlock(server->lock);
+
+    if (!endpoint) {
+        send_head(fd, 404, "text/plain", 0, NULL);
+        return;
+    }
+
+    const char *relative_url = path + strlen(endpoint->url);
+    if (relative_url[0] == '/') {
+        relative_url ++;
+    }
+
+    EcsHttpRequest request = {
+        .url = path,
+        .relative_url = relative_url,
+        .params = params,
+        .method = http_method
+    };
+
+    EcsHttpReply reply = {
+        .status = 200
+    };
+
+    bool result;
+    if (endpoint->endpoint.synchronous) {
+        result = run_sync(server, endpoint, &request, &reply);
+    } else {
+        ecs_lock(server->world);
+        result = endpoint->endpoint.action(server->world, endpoint->entity,
+            &endpoint->endpoint, &request, &reply);
+        ecs_unlock(server->world);
+    }
+
+    if (!result) {
+        int status = reply.status != 200 ? reply.status : 404;
+        send_head(fd, status, "text/plain", 0, reply.header);
+    } else if (reply.is_file) {
+        send_file(fd, reply.body);
+    } else {
+        size_t length = reply.body ? strlen(reply.body) : 0;
+        send_head(fd, reply.status, "application/json", length, reply.header);
+        if (length) {
+            send_all(fd, reply.body, length);
+        }
+    }
+
+    ecs_os_free(reply.body);
+    ecs_os_free(reply.header);
+}
+
+static
+void* standin_thread(
+    void *arg)
+{
+    standin_server_t *server = arg;
+
+    while (true) {
+        ecs_os_mutex_lock(server->lock);
+        while (!server->queue_count) {
+            ecs_os_cond_wait(server->queue_cond, server->lock);
+        }
+
+        int fd = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % STANDIN_QUEUE_SIZE;
+        server->queue_count --;
+        ecs_os_mutex_unlock(server->lock);
+
+        handle_connection(server, fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+static
+void* standin_accept(
+    void *arg)
+{
+    standin_server_t *server = arg;
+
+    while (true) {
+        int fd = accept(server->socket, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            ecs_os_err("loadtest: accept failed: %s", strerror(errno));
+            break;
+        }
+
+        ecs_os_mutex_lock(server->lock);
+        if (server->queue_count == STANDIN_QUEUE_SIZE) {
+            /* Connection threads can't keep up, drop the connection */
+            ecs_os_mutex_unlock(server->lock);
+            close(fd);
+            continue;
+        }
+
+        uint32_t index =
+            (server->queue_head + server->queue_count) % STANDIN_QUEUE_SIZE;
+        server->queue[index] = fd;
+        server->queue_count ++;
+        ecs_os_cond_signal(server->queue_cond);
+        ecs_os_mutex_unlock(server->lock);
+    }
+
+    return NULL;
+}
+
+static
+standin_server_t* standin_new(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        ecs_os_err("loadtest: cannot create socket: %s", strerror(errno));
+        return NULL;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+        listen(fd, STANDIN_QUEUE_SIZE))
+    {
+        ecs_os_err("loadtest: cannot listen on :%u: %s", port, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    standin_server_t *result = ecs_os_calloc(1, sizeof(standin_server_t));
+    result->world = world;
+    result->entity = entity;
+    result->socket = fd;
+    result->lock = ecs_os_mutex_new();
+    result->queue_cond = ecs_os_cond_new();
+    result->sync_cond = ecs_os_cond_new();
+    result->endpoints = ecs_vector_new(&ptr_params, 0);
+    result->sync = ecs_vector_new(&ptr_params, 0);
+
+    /* Endpoints that are not synchronous lock the world */
+    ecs_enable_locking(world, true);
+
+    int i;
+    for (i = 0; i < STANDIN_THREADS; i ++) {
+        result->threads[i] = ecs_os_thread_new(standin_thread, result);
+    }
+
+    result->accept_thread = ecs_os_thread_new(standin_accept, result);
+
+    return result;
+}
+
+/* Start server when an EcsHttpServer component is set */
+static
+void LoadtestHttpStart(ecs_rows_t *rows) {
+    EcsHttpServer *server = ecs_column(rows, EcsHttpServer, 1);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        if (standin) {
+            ecs_os_err("loadtest: stand-in server already running");
+            continue;
+        }
+
+        standin = standin_new(rows->world, rows->entities[i], server[i].port);
+        if (standin) {
+            ecs_os_log("loadtest: stand-in server running on :%u",
+                server[i].port);
+        }
+    }
+}
+
+/* Register endpoints that are created for the server */
+static
+void LoadtestHttpEndpoint(ecs_rows_t *rows) {
+    EcsHttpEndpoint *endpoint = ecs_column(rows, EcsHttpEndpoint, 1);
+
+    if (!standin) {
+        return;
+    }
+
+    ecs_os_mutex_lock(standin->lock);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        standin_endpoint_t *e = ecs_os_malloc(sizeof(standin_endpoint_t));
+        e->url = standin_strdup(endpoint[i].url);
+        e->entity = rows->entities[i];
+        e->endpoint = endpoint[i];
+
+        standin_endpoint_t **elem =
+            ecs_vector_add(&standin->endpoints, &ptr_params);
+        *elem = e;
+    }
+
+    ecs_os_mutex_unlock(standin->lock);
+}
+
+/* Process requests for synchronous endpoints on the main thread */
+static
+void LoadtestHttpProcess(ecs_rows_t *rows) {
+    if (!standin) {
+        return;
+    }
+
+    /* Take the pending requests, so that connection threads are not blocked
+     * while the actions run */
+    ecs_os_mutex_lock(standin->lock);
+    ecs_vector_t *pending = NULL;
+    if (ecs_vector_count(standin->sync)) {
+        pending = standin->sync;
+        standin->sync = ecs_vector_new(&ptr_params, 0);
+    }
+    ecs_os_mutex_unlock(standin->lock);
+
+    if (!pending) {
+        return;
+    }
+
+    standin_sync_t **buffer = ecs_vector_first(pending);
+    uint32_t i, count = ecs_vector_count(pending);
+
+    for (i = 0; i < count; i ++) {
+        standin_sync_t *sync = buffer[i];
+        standin_endpoint_t *endpoint = sync->endpoint;
+        sync->result = endpoint->endpoint.action(rows->world, endpoint->entity,
+            &endpoint->endpoint, sync->request, sync->reply);
+    }
+
+    ecs_os_mutex_lock(standin->lock);
+    for (i = 0; i < count; i ++) {
+        buffer[i]->done = true;
+    }
+    ecs_os_cond_broadcast(standin->sync_cond);
+    ecs_os_mutex_unlock(standin->lock);
+
+    ecs_vector_free(pending);
+}
+
+void LoadtestHttpImport(
+    ecs_world_t *world,
+    int flags)
+{
+    ECS_IMPORT(world, FlecsComponentsHttp, 0);
+
+    ECS_MODULE(world, LoadtestHttp);
+
+    ECS_SYSTEM(world, LoadtestHttpStart, EcsOnSet, EcsHttpServer,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, LoadtestHttpEndpoint, EcsOnSet, EcsHttpEndpoint,
+        CONTAINER.EcsHttpServer, SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, LoadtestHttpProcess, EcsOnLoad, SYSTEM.EcsHidden);
+
+    ECS_EXPORT_ENTITY(LoadtestHttpProcess);
+}
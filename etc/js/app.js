@@ -1,5 +1,28 @@
 var host = "";
 
+// Limit the number of components and types in the world reply, so the reply
+// stays small for worlds with many components and types. The complete lists
+// can be paged through with the components and types endpoints.
+var world_params = "component_limit=100&type_sort=systems&type_limit=100";
+
+// Path of the world that is shown. When the admin serves multiple worlds, this
+// is set to "worlds/<name>/" for worlds other than the world that runs the
+// server.
+var world_path = "";
+
+// System or component of which history is requested. Hidden systems and
+// components that are not used only get history when it is requested.
+var world_history = "";
+
+function request_history(name) {
+  world_history = name;
+}
+
+// Parses world replies off the main thread (see worker.js)
+var world_worker;
+var world_worker_failed = false;
+var world_pending = false;
+
 var colors = [
     "#B7CB2A",
     "#8DB3CC",
@@ -43,6 +66,9 @@ Vue.component('app-menu', {
       <div :class="cssClass('performance')" @click="nav('performance')">Performance</div>
       <div :class="cssClass('memory')" @click="nav('memory')">Memory</div>
       <div :class="cssClass('systems')" @click="nav('systems')">Systems</div>
+      <div :class="cssClass('metrics')" @click="nav('metrics')">Metrics</div>
+      <div :class="cssClass('compare')" @click="nav('compare')">Compare</div>
+      <div :class="cssClass('worlds')" @click="nav('worlds')">Worlds</div>
     </div>`
 });
 
@@ -84,32 +110,72 @@ var app = new Vue({
         }
       }
     },
-    set_system_colors() {
-      this.set_system_array_colors(this.world.systems.on_load);
-      this.set_system_array_colors(this.world.systems.post_load);
-      this.set_system_array_colors(this.world.systems.pre_update);
-      this.set_system_array_colors(this.world.systems.on_update);
-      this.set_system_array_colors(this.world.systems.on_validate);
-      this.set_system_array_colors(this.world.systems.post_update);
-      this.set_system_array_colors(this.world.systems.pre_store);
-      this.set_system_array_colors(this.world.systems.on_store);
-      this.set_system_array_colors(this.world.systems.manual);
+    set_system_colors(world) {
+      this.set_system_array_colors(world.systems.on_load);
+      this.set_system_array_colors(world.systems.post_load);
+      this.set_system_array_colors(world.systems.pre_update);
+      this.set_system_array_colors(world.systems.on_update);
+      this.set_system_array_colors(world.systems.on_validate);
+      this.set_system_array_colors(world.systems.post_update);
+      this.set_system_array_colors(world.systems.pre_store);
+      this.set_system_array_colors(world.systems.on_store);
+      this.set_system_array_colors(world.systems.manual);
+    },
+    set_world(world) {
+      var prev = this.world.tick;
+      if (!prev) prev = 0;
+      world.tick = prev + 1;
+      this.set_system_colors(world);
+      world.system_colors = this.system_colors;
+
+      // The dashboard does not modify replies. Freezing the reply prevents Vue
+      // from making every value in it reactive, which for worlds with many
+      // systems costs more than parsing the reply.
+      this.world = Object.freeze(world);
     },
     refresh() {
-      const Http = new XMLHttpRequest();
       host = this.host;
-      const url = "http://" + this.host + "/world";
+      var url = "http://" + this.host + "/" + world_path + "world?" + world_params;
+      if (world_history) {
+        url += "&history=" + encodeURIComponent(world_history);
+      }
+
+      // Don't queue requests when the server replies slower than the refresh
+      // interval
+      if (world_pending) {
+        return;
+      }
+
+      if (window.Worker && !world_worker_failed) {
+        if (!world_worker) {
+          world_worker = new Worker("js/worker.js");
+          world_worker.onmessage = (e)=>{
+            world_pending = false;
+            if (e.data.world) {
+              this.set_world(e.data.world);
+            }
+          }
+          world_worker.onerror = (e)=>{
+            // Workers can't be loaded from file:// urls in some browsers
+            world_worker_failed = true;
+            world_pending = false;
+          }
+        }
+
+        world_pending = true;
+        world_worker.postMessage({url: url});
+        return;
+      }
+
+      const Http = new XMLHttpRequest();
       Http.open("GET", url);
       Http.send();
+      world_pending = true;
       Http.onreadystatechange = (e)=>{
         if (Http.readyState == 4) {
-          if (Http.responseText && Http.responseText.length) {
-            var prev = this.world.tick;
-            if (!prev) prev = 0;
-            this.world = JSON.parse(Http.responseText);
-            this.world.tick = prev + 1;
-            this.set_system_colors();
-            this.world.system_colors = this.system_colors;
+          world_pending = false;
+          if (Http.status == 200 && Http.responseText && Http.responseText.length) {
+            this.set_world(JSON.parse(Http.responseText));
           }
         }
       }
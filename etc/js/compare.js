@@ -0,0 +1,206 @@
+
+// Compare current statistics with a baseline snapshot. Snapshots are captured
+// by the admin, so that they contain the averages of the last minute.
+Vue.component('app-compare-snapshots', {
+  props: ['snapshots', 'selected'],
+  data: function() {
+    return {
+      name: "baseline"
+    }
+  },
+  methods: {
+    capture() {
+      this.$emit('capture', this.name);
+    },
+    rowClass(snapshot) {
+      if (snapshot.name == this.selected) {
+        return "app-world-selected";
+      } else {
+        return "";
+      }
+    }
+  },
+  template: `
+    <div class="app-table">
+      <div class="app-table-top">
+        <h2>snapshots</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>name</th>
+              <th>age</th>
+              <th>metrics</th>
+              <th></th>
+            </tr>
+          </thead>
+          <tbody>
+            <tr v-for="snapshot in snapshots" :class="rowClass(snapshot)" @click="$emit('select', snapshot.name)">
+              <td>{{snapshot.name}}</td>
+              <td>{{snapshot.age.toFixed(0)}}s</td>
+              <td>{{snapshot.entry_count}}</td>
+              <td>
+                <div class="app-toggle" @click.stop="$emit('remove', snapshot.name)">remove</div>
+              </td>
+            </tr>
+            <tr>
+              <td><input v-model="name"></td>
+              <td></td>
+              <td></td>
+              <td>
+                <div class="app-toggle" @click="capture">capture</div>
+              </td>
+            </tr>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
+Vue.component('app-compare-diff', {
+  props: ['diff'],
+  methods: {
+    value(v) {
+      if (v) {
+        return v.avg_1m.toFixed(2);
+      } else {
+        return "-";
+      }
+    },
+    relative(d) {
+      if (d.relative === null) {
+        return "new";
+      } else {
+        var pct = d.relative * 100;
+        return (pct > 0 ? "+" : "") + pct.toFixed(1) + "%";
+      }
+    }
+  },
+  template: `
+    <div class="app-table">
+      <div class="app-table-top">
+        <h2>changes since {{diff.from}} ({{diff.count}} metrics changed, 1m averages)</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>kind</th>
+              <th>name</th>
+              <th>metric</th>
+              <th>{{diff.from}}</th>
+              <th>{{diff.to}}</th>
+              <th>delta</th>
+              <th>change</th>
+            </tr>
+          </thead>
+          <tbody>
+            <tr v-for="d in diff.diffs">
+              <td>{{d.kind}}</td>
+              <td>{{d.name}}</td>
+              <td>{{d.metric}}</td>
+              <td>{{value(d.from)}}</td>
+              <td>{{value(d.to)}}</td>
+              <td>{{d.delta.toFixed(2)}}</td>
+              <td>{{relative(d)}}</td>
+            </tr>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
+Vue.component('app-compare', {
+  props: ['world'],
+  data: function() {
+    return {
+      active: false,
+      snapshots: [],
+      selected: undefined,
+      diff: undefined
+    }
+  },
+  mounted() {
+    setTimeout(function() {
+      this.active = true;
+    }.bind(this), 10);
+    this.request("GET", "snapshots");
+  },
+  beforeDestroy() {
+    this.active = false;
+  },
+  watch: {
+    'world.tick': function() {
+      if (!(this.world.tick % 5)) {
+        this.requestDiff();
+      }
+    }
+  },
+  methods: {
+    request(method, path, done) {
+      const Http = new XMLHttpRequest();
+      const url = "http://" + host + "/" + path;
+      Http.open(method, url);
+      Http.send();
+      Http.onreadystatechange = (e)=>{
+        if (Http.readyState == 4) {
+          if (Http.responseText && Http.responseText.length) {
+            this.snapshots = JSON.parse(Http.responseText);
+          }
+          if (done) {
+            done();
+          }
+        }
+      }
+    },
+    requestDiff() {
+      if (!this.selected) {
+        return;
+      }
+      const Http = new XMLHttpRequest();
+      const url = "http://" + host + "/diff?limit=50&from=" + this.selected;
+      Http.open("GET", url);
+      Http.send();
+      Http.onreadystatechange = (e)=>{
+        if (Http.readyState == 4) {
+          if (Http.responseText && Http.responseText.length) {
+            this.diff = JSON.parse(Http.responseText);
+          }
+        }
+      }
+    },
+    capture(name) {
+      this.request("POST", "snapshots/" + name, () => {
+        this.select(name);
+      });
+    },
+    remove(name) {
+      this.request("DELETE", "snapshots/" + name);
+      if (this.selected == name) {
+        this.selected = undefined;
+        this.diff = undefined;
+      }
+    },
+    select(name) {
+      this.selected = name;
+      this.requestDiff();
+    }
+  },
+  template: `
+    <div :class="'app app-active-' + active">
+      <div class="app-row">
+        <app-compare-snapshots
+          :snapshots="snapshots"
+          :selected="selected"
+          v-on:capture="capture"
+          v-on:remove="remove"
+          v-on:select="select">
+        </app-compare-snapshots>
+      </div>
+      <div class="app-row" v-if="diff">
+        <app-compare-diff :diff="diff">
+        </app-compare-diff>
+      </div>
+    </div>`
+});
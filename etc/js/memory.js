@@ -257,15 +257,8 @@ Vue.component('app-mem-categories-graph', {
 Vue.component('app-mem-table-row', {
   props: ['world', 'table'],
   methods: {
-    columnsString() {
-      return shortenText(this.table.columns, 30);
-    },
-    tableId() {
-      if (this.table.id) {
-        return this.table.id;
-      } else {
-        return ""
-      }
+    toKB(num) {
+      return (num / 1000).toFixed(2) + "KB";
     },
     tableColumns() {
       return shortenText(this.table.columns);
@@ -276,32 +269,164 @@ Vue.component('app-mem-table-row', {
   },
   template: `
   <tr>
-    <td>{{tableId()}}</td>
     <td>{{tableColumns()}}</td>
-    <td>{{table.row_count}}</td>
+    <td>{{table.row_count}} / {{table.capacity}}</td>
+    <td>{{table.row_size}}B</td>
     <td>{{toKB(table.memory_used)}}</td>
     <td>{{toKB(table.memory_allocd)}}</td>
   </tr>`
 });
 
-Vue.component('app-mem-comp-table', {
+Vue.component('app-mem-tables', {
   props: ['world'],
+  data: function() {
+    return {
+      tables: undefined
+    }
+  },
+  mounted() {
+    this.requestTables();
+  },
+  watch: {
+    'world.tick': function() {
+      // Table statistics are collected by walking all tables, so don't
+      // request them as often as the world statistics.
+      if (!(this.world.tick % 5)) {
+        this.requestTables();
+      }
+    }
+  },
   methods: {
     toKB(num) {
       return (num / 1000).toFixed(2) + "KB";
+    },
+    requestTables() {
+      const Http = new XMLHttpRequest();
+      const url = "http://" + host + "/" + world_path + "tables?sort=waste&limit=20";
+      Http.open("GET", url);
+      Http.send();
+      Http.onreadystatechange = (e)=>{
+        if (Http.readyState == 4) {
+          if (Http.responseText && Http.responseText.length) {
+            this.tables = JSON.parse(Http.responseText);
+          }
+        }
+      }
     }
   },
-  computed: {
-    sorted_components: function() {
-      var arr = this.world.components.slice();
-      return arr.sort((el1, el2) => {
-        return el2.memory.used.current - el1.memory.used.current;
-      });
+  template: `
+    <div class="app-table" v-if="tables">
+      <div class="app-table-top">
+        <h2>tables ({{tables.table_count}} tables, 
+          {{tables.empty_table_count}} empty, 
+          {{tables.small_table_count}} with {{tables.small_table_rows}} or less rows, 
+          {{tables.avg_rows.toFixed(1)}} rows on average, 
+          {{toKB(tables.memory_allocd - tables.memory_used)}} unused)</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>type</th>
+              <th>rows</th>
+              <th>row size</th>
+              <th>in use</th>
+              <th>allocated</th>
+            </tr>
+          </thead>
+          <tbody>
+            <app-mem-table-row
+              v-for="(table, index) in tables.tables"
+              :key="index"
+              :table="table">
+            </app-mem-table-row>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
+Vue.component('app-mem-comp-table', {
+  props: ['world'],
+  data: function() {
+    return {
+      sort: "memory",
+      cursor: 0,
+      limit: 50,
+      page: undefined
+    }
+  },
+  mounted() {
+    this.requestPage();
+  },
+  watch: {
+    'world.tick': function() {
+      this.requestPage();
+    }
+  },
+  methods: {
+    toKB(num) {
+      return (num / 1000).toFixed(2) + "KB";
+    },
+    rowClass(component) {
+      if (memoryIsGrowing(component.memory)) {
+        return "app-mem-growing";
+      } else {
+        return "";
+      }
+    },
+    requestHistory(component) {
+      request_history(component.name);
+      this.requestPage();
+    },
+    requestPage() {
+      const Http = new XMLHttpRequest();
+      var url = "http://" + host + "/" + world_path + "components?sort=" + this.sort +
+        "&limit=" + this.limit + "&cursor=" + this.cursor;
+      if (world_history) {
+        url += "&history=" + encodeURIComponent(world_history);
+      }
+      Http.open("GET", url);
+      Http.send();
+      Http.onreadystatechange = (e)=>{
+        if (Http.readyState == 4) {
+          if (Http.responseText && Http.responseText.length) {
+            this.page = JSON.parse(Http.responseText);
+          }
+        }
+      }
+    },
+    setSort(sort) {
+      this.sort = sort;
+      this.cursor = 0;
+      this.requestPage();
+    },
+    prevPage() {
+      this.cursor = Math.max(0, this.cursor - this.limit);
+      this.requestPage();
+    },
+    nextPage() {
+      if (this.page && this.page.next_cursor != null) {
+        this.cursor = this.page.next_cursor;
+        this.requestPage();
+      }
+    },
+    pageText() {
+      if (!this.page || !this.page.count) {
+        return "";
+      }
+      var last = Math.min(this.cursor + this.limit, this.page.count);
+      return (this.cursor + 1) + " - " + last + " of " + this.page.count;
     }
   },
   template: `
     <div class="app-table">
     <div class="app-table-top">
+      <span class="app-table-pager">
+        <span @click="prevPage()" v-if="cursor">&lt;</span>
+        {{pageText()}}
+        <span @click="nextPage()" v-if="page && page.next_cursor != null">&gt;</span>
+      </span>
       <h2>components</h2>
     </div>    
       <div class="app-noscroll-table-content">
@@ -309,17 +434,25 @@ Vue.component('app-mem-comp-table', {
           <thead>
             <tr>
               <th>id</th>
-              <th>in use</th>
-              <th>entities</th>
-              <th>tables</th>
+              <th @click="setSort('memory')">in use</th>
+              <th @click="setSort('entities')">entities</th>
+              <th @click="setSort('tables')">tables</th>
+              <th @click="setSort('churn')">churn</th>
             </tr>
           </thead>
-          <tbody>
-            <tr v-for="component in sorted_components">
-            <td>{{component.name}}</td>
+          <tbody v-if="page">
+            <tr v-for="component in page.components" :key="component.entity"
+              :class="rowClass(component)">
+            <td>
+              {{component.name}}
+              <span v-if="!component.history" class="app-history-request"
+                title="Collect history for this component"
+                @click="requestHistory(component)">+history</span>
+            </td>
             <td>{{toKB(component.memory.used.current)}}</td>
             <td>{{component.entity_count}}</td>
             <td>{{component.table_count}}</td>
+            <td>{{component.entity_rate.current.toFixed(2)}}/s</td>
             </tr>
           </tbody>
         </table>
@@ -352,15 +485,8 @@ Vue.component('app-mem-comp-graph', {
       return result / length;
     },
     setValues() {
-      var labels = [];
       var components = this.world.components;
-
-      var length = this.world.frame.data_1m.length;
-      for (var i = 0; i < length; i ++) {
-          labels.push((length  - i) + "s");
-      }
-
-      app_mem.comp_1min_chart.data.labels = labels;
+      var series = [[]];
 
       var dataset = 1;
       for (var i = 0; i < components.length; i ++) {
@@ -375,12 +501,12 @@ Vue.component('app-mem-comp-graph', {
 
           if (this.avgMem(component) < (this.world.memory.components.used.current / 10.0)) {
             app_mem.comp_1min_chart.data.datasets[0].label = "Other";
-            app_mem.comp_1min_chart.data.datasets[0].data = component.memory.used.data_1m;
+            series[0] = component.memory.used.data_1m;
             app_mem.comp_1min_chart.data.datasets[0].borderColor = "#000";
             app_mem.comp_1min_chart.data.datasets[0].backgroundColor = colors[0];
           } else {
             app_mem.comp_1min_chart.data.datasets[dataset].label = component.name;
-            app_mem.comp_1min_chart.data.datasets[dataset].data = component.memory.used.data_1m;
+            series.push(component.memory.used.data_1m);
             app_mem.comp_1min_chart.data.datasets[dataset].borderColor = "#000";
             app_mem.comp_1min_chart.data.datasets[dataset].backgroundColor = colors[dataset % colors.length];
             dataset ++;
@@ -389,6 +515,8 @@ Vue.component('app-mem-comp-graph', {
       }
 
       app_mem.comp_1min_chart.data.datasets.length = dataset;
+
+      setChartData(this.chart, app_mem.comp_1min_chart, series, "s");
     },
     createChart() {
       const ctx = document.getElementById('comp-1min-graph');
@@ -410,6 +538,81 @@ Vue.component('app-mem-comp-graph', {
     </div>`
 });
 
+// Memory shows sustained growth when both the last hour and the long term
+// trend are growing.
+function memoryIsGrowing(memory) {
+  return memory.trend_1h && memory.trend_1h.growing && memory.trend_long.growing;
+}
+
+Vue.component('app-mem-trends', {
+  props: ['world'],
+  methods: {
+    categories() {
+      var memory = this.world.memory;
+      return [
+        {name: "total", memory: memory.total},
+        {name: "components", memory: memory.components},
+        {name: "entities", memory: memory.entities},
+        {name: "systems", memory: memory.systems},
+        {name: "types", memory: memory.types},
+        {name: "tables", memory: memory.tables},
+        {name: "stages", memory: memory.stages},
+        {name: "world", memory: memory.world}
+      ];
+    },
+    growth(trend) {
+      return (trend.slope * 60 / 1000).toFixed(2) + " KB/min";
+    },
+    rowClass(memory) {
+      if (memoryIsGrowing(memory)) {
+        return "app-mem-growing";
+      } else {
+        return "";
+      }
+    },
+    timeToLimit() {
+      var seconds = this.world.memory.projection.seconds_to_limit;
+      if (seconds == null) {
+        return "-";
+      } else {
+        return moment.duration(seconds, "seconds").humanize();
+      }
+    }
+  },
+  template: `
+    <div class="app-table">
+      <div class="app-table-top">
+        <h2>memory growth</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>category</th>
+              <th>growth (1h)</th>
+              <th>confidence (1h)</th>
+              <th>growth (long)</th>
+              <th>confidence (long)</th>
+            </tr>
+          </thead>
+          <tbody>
+            <tr v-for="category in categories()" :class="rowClass(category.memory)">
+              <td>{{category.name}}</td>
+              <td>{{growth(category.memory.trend_1h)}}</td>
+              <td>{{category.memory.trend_1h.r2.toFixed(2)}}</td>
+              <td>{{growth(category.memory.trend_long)}}</td>
+              <td>{{category.memory.trend_long.r2.toFixed(2)}}</td>
+            </tr>
+            <tr v-if="world.memory.projection.limit">
+              <td>time to limit</td>
+              <td colspan="4">{{timeToLimit()}}</td>
+            </tr>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
 Vue.component('app-mem-data', {
   props: ['world'],
   methods: {
@@ -480,6 +683,10 @@ Vue.component('app-memory', {
           </app-mem-total-graph>
         </div>
       </div>
+      <div class="app-row" v-if="world.memory.projection">
+        <app-mem-trends :world="world">
+        </app-mem-trends>
+      </div>
       <div class="app-row">
         <app-mem-comp-graph :world="world">
         </app-mem-comp-graph>
@@ -488,5 +695,9 @@ Vue.component('app-memory', {
         <app-mem-comp-table :world="world">
         </app-mem-comp-table>
       </div>
+      <div class="app-row">
+        <app-mem-tables :world="world">
+        </app-mem-tables>
+      </div>
     </div>`
 });
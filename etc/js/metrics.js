@@ -0,0 +1,170 @@
+
+var app_metrics = {
+  metric_chart(metric) {
+    return {
+      type: 'line',
+      data: {
+        labels: [],
+        datasets: [
+          {
+            label: metric.name,
+            data: [],
+            backgroundColor: [ 'rgba(0,0,0,0)' ],
+            borderColor: [ '#5BE595' ],
+            borderWidth: 2,
+            pointRadius: 0
+          }
+        ]
+      },
+      options: {
+        title: {
+          text: metric.name + " (1m)",
+          position: "top",
+          display: true
+        },
+        legend: {
+          display: false
+        },
+        responsive: true,
+        maintainAspectRatio: false,
+        lineTension: 1,
+        scales: {
+          yAxes: [{
+            ticks: {
+              beginAtZero: true,
+              padding: 25,
+              callback: function(value, index, values) {
+                return value + app_metrics.unit(metric);
+              }
+            }
+          }],
+          xAxes: [{
+            ticks: {
+              maxTicksLimit: 20
+            }
+          }]
+        }
+      }
+    }
+  },
+  unit(metric) {
+    var unit = metric.unit;
+    if (metric.kind == "counter") {
+      if (unit.length) {
+        unit += "/s";
+      } else {
+        unit = "/s";
+      }
+    }
+    return unit;
+  }
+}
+
+// Generic chart for an application-defined metric. Charts are created per
+// component instance, as the number of metrics is not known in advance.
+Vue.component('app-metric-graph', {
+  props: ['world', 'metric'],
+  mounted() {
+    this.createChart();
+  },
+  updated() {
+    this.updateChart();
+  },
+  data: function() {
+    return {
+      chart: undefined,
+      config: undefined
+    }
+  },
+  methods: {
+    canvasId() {
+      return "metric-graph-" + this.metric.name;
+    },
+    setValues() {
+      var labels = [];
+      var length = this.metric.value.data_1m.length;
+      for (var i = 0; i < length; i ++) {
+          labels.push((length  - i) + "s");
+      }
+
+      this.config.data.labels = labels;
+      this.config.data.datasets[0].data = this.metric.value.data_1m;
+    },
+    createChart() {
+      const ctx = document.getElementById(this.canvasId());
+      this.config = app_metrics.metric_chart(this.metric);
+      this.setValues();
+      this.chart = new Chart(ctx, this.config);
+    },
+    updateChart() {
+      this.setValues();
+      this.chart.update(0);
+    }
+  },
+  template: `
+    <div class="app-graph">
+      <canvas :id="canvasId()" :data-fps="world.tick"></canvas>
+    </div>`
+});
+
+Vue.component('app-metrics-table', {
+  props: ['world'],
+  methods: {
+    unit(metric) {
+      return app_metrics.unit(metric);
+    }
+  },
+  template: `
+    <div class="app-table">
+      <div class="app-table-top">
+        <h2>metrics</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>id</th>
+              <th>kind</th>
+              <th>current</th>
+            </tr>
+          </thead>
+          <tbody>
+            <tr v-for="metric in world.metrics" :key="metric.name">
+              <td>{{metric.name}}</td>
+              <td>{{metric.kind}}</td>
+              <td>{{metric.value.current.toFixed(2)}}{{unit(metric)}}</td>
+            </tr>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
+Vue.component('app-metrics', {
+  props: ['world'],
+  data: function() {
+    return {
+        active: false
+    }
+  },
+  mounted() {
+    setTimeout(function() {
+      this.active = true;
+    }.bind(this), 10);
+  },
+  beforeDestroy() {
+    this.active = false;
+  },
+  template: `
+    <div :class="'app app-active-' + active">
+      <div class="app-row">
+        <app-metrics-table :world="world">
+        </app-metrics-table>
+      </div>
+
+      <div class="app-fixed-row" v-for="metric in world.metrics" :key="metric.name">
+        <app-metric-graph :world="world" :metric="metric" v-if="metric.value.data_1m.length">
+        </app-metric-graph>
+      </div>
+    </div>`
+});
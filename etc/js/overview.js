@@ -15,7 +15,8 @@ var world_state = {
     min_1h:[],
     max_1h:[]
   },
-  memory: {}
+  memory: {},
+  metrics: []
 }
 
 var app_overview = {
@@ -169,17 +170,12 @@ Vue.component('app-overview-fps-graph', {
   },
   methods: {
     setValues() {
-      var labels = [];
-      var length = this.world.fps.data_1m.length;
-      for (var i = 0; i < length; i ++) {
-          labels.push((length  - i) + "s");
-      }
-
-      app_overview.fps_chart.data.labels = labels;
-      app_overview.fps_chart.data.datasets[0].data = this.world.fps.data_1m;
-      app_overview.fps_chart.data.datasets[3].data = this.world.frame.data_1m;
-      app_overview.fps_chart.data.datasets[1].data = this.world.system.data_1m;
-      app_overview.fps_chart.data.datasets[2].data = this.world.merge.data_1m;
+      setChartData(this.chart, app_overview.fps_chart, [
+        this.world.fps.data_1m,
+        this.world.system.data_1m,
+        this.world.merge.data_1m,
+        this.world.frame.data_1m
+      ], "s");
     },
     createChart() {
       const ctx = document.getElementById('fps-graph');
@@ -213,6 +213,115 @@ var app_performance = {
     }
   },
 
+  phase_chart: {
+    type: 'line',
+    data: {
+      labels: [],
+      datasets: []
+    },
+    options: {
+      title: {
+        text: "Frame budget per phase (1m)",
+        position: "top",
+        display: true
+      },
+      legend: {
+        position: "right"
+      },
+      responsive: true,
+      maintainAspectRatio: false,
+      lineTension: 1,
+      scales: {
+        yAxes: [{
+          stacked: true,
+          ticks: {
+            beginAtZero: true,
+            padding: 25,
+            callback: function(value, index, values) {
+                return value + "%";
+            }
+          }
+        }],
+        xAxes: [{
+          ticks: {
+            maxTicksLimit: 20
+          }
+        }]
+      }
+    }
+  },
+
+  jitter_chart: {
+    type: 'line',
+    data: {
+      labels: [],
+      datasets: [
+        {
+          label: 'Frame time',
+          data: [],
+          backgroundColor: [ 'rgba(0,0,0,0)' ],
+          borderColor: [ '#5BE595' ],
+          borderWidth: 1,
+          pointRadius: 0
+        },
+        {
+          label: 'Smoothed',
+          data: [],
+          backgroundColor: [ 'rgba(0,0,0,0)' ],
+          borderColor: [ '#4596E5' ],
+          borderWidth: 2,
+          pointRadius: 0
+        },
+        {
+          label: 'Jitter (stddev)',
+          data: [],
+          backgroundColor: [ 'rgba(0,0,0,0)' ],
+          borderColor: [ '#E550E6' ],
+          borderWidth: 2,
+          pointRadius: 0
+        }
+      ]
+    },
+    options: {
+      title: {
+        text: "Frame time jitter (1m)",
+        position: "top",
+        display: true
+      },
+      responsive: true,
+      maintainAspectRatio: false,
+      lineTension: 1,
+      scales: {
+        yAxes: [{
+          ticks: {
+            beginAtZero: true,
+            padding: 25,
+            callback: function(value, index, values) {
+                return value + "%";
+            }
+          }
+        }],
+        xAxes: [{
+          ticks: {
+            maxTicksLimit: 20
+          }
+        }]
+      }
+    }
+  },
+
+  phases: [
+    {id: "on_load", label: "OnLoad"},
+    {id: "post_load", label: "PostLoad"},
+    {id: "pre_update", label: "PreUpdate"},
+    {id: "on_update", label: "OnUpdate"},
+    {id: "on_validate", label: "OnValidate"},
+    {id: "post_update", label: "PostUpdate"},
+    {id: "pre_store", label: "PreStore"},
+    {id: "on_store", label: "OnStore"},
+    {id: "manual", label: "Manual"}
+  ],
+
   mem_chart: {
     type: 'doughnut',
     data: {
@@ -241,6 +350,11 @@ var app_performance = {
 }
 
 function systemActivity1m(system) {
+  // Computed by the worker that parsed the reply
+  if (system && system.activity_1m) {
+    return system.activity_1m;
+  }
+
   var result = 0;
   var max = 0;
   if (system) {
@@ -331,8 +445,6 @@ Vue.component('app-performance-fps-1hr-graph', {
   },
   methods: {
     setValues() {
-      var labels = [];
-
       var merge = [];
       var merge_min = [];
       var merge_max = [];
@@ -340,7 +452,6 @@ Vue.component('app-performance-fps-1hr-graph', {
       var length = this.world.fps.data_1h.length;
 
       for (var i = 0; i < length; i ++) {
-          labels.push((length - i) + "m");
           var frame = this.world.frame.data_1h[i];
           var system = this.world.system.data_1h[i];
           merge.push(frame - system);
@@ -354,22 +465,23 @@ Vue.component('app-performance-fps-1hr-graph', {
           merge_max.push(frame_max - system_max);
       }
 
-      app_performance.fps_1hr_chart.data.labels = labels;
-      app_performance.fps_1hr_chart.data.datasets[0].data = this.world.fps.data_1h;
-      app_performance.fps_1hr_chart.data.datasets[1].data = this.world.fps.min_1h;
-      app_performance.fps_1hr_chart.data.datasets[2].data = this.world.fps.max_1h;
+      setChartData(this.chart, app_performance.fps_1hr_chart, [
+        this.world.fps.data_1h,
+        this.world.fps.min_1h,
+        this.world.fps.max_1h,
 
-      app_performance.fps_1hr_chart.data.datasets[3].data = this.world.system.data_1h;
-      app_performance.fps_1hr_chart.data.datasets[4].data = this.world.system.min_1h;
-      app_performance.fps_1hr_chart.data.datasets[5].data = this.world.system.max_1h;
+        this.world.system.data_1h,
+        this.world.system.min_1h,
+        this.world.system.max_1h,
 
-      app_performance.fps_1hr_chart.data.datasets[6].data = merge;
-      app_performance.fps_1hr_chart.data.datasets[7].data = merge_min;
-      app_performance.fps_1hr_chart.data.datasets[8].data = merge_max;
+        merge,
+        merge_min,
+        merge_max,
 
-      app_performance.fps_1hr_chart.data.datasets[9].data = this.world.frame.data_1h;
-      app_performance.fps_1hr_chart.data.datasets[10].data = this.world.frame.min_1h;
-      app_performance.fps_1hr_chart.data.datasets[11].data = this.world.frame.max_1h;
+        this.world.frame.data_1h,
+        this.world.frame.min_1h,
+        this.world.frame.max_1h
+      ], "m");
     },
 
     createChart() {
@@ -407,17 +519,8 @@ Vue.component('app-performance-sys-1min-graph', {
   },
   methods: {
     setValues() {
-      var labels = [];
-      var frame_pct = [];
-
-      var length = this.world.frame.data_1m.length;
-      for (var i = 0; i < length; i ++) {
-          labels.push((length  - i) + "s");
-      }
-
-      app_performance.sys_1min_chart.data.labels = labels;
-
       var systems = getActiveSystems1m(this.world);
+      var series = [];
 
       var dataset = 0;
       for (var i = 0; i < systems.length; i ++) {
@@ -431,7 +534,7 @@ Vue.component('app-performance-sys-1min-graph', {
           }
           
           app_performance.sys_1min_chart.data.datasets[dataset].label = system.name;
-          app_performance.sys_1min_chart.data.datasets[dataset].data = system.time_spent_pct.data_1m;
+          series.push(system.time_spent_pct.data_1m);
           app_performance.sys_1min_chart.data.datasets[dataset].borderColor = "#000";
           app_performance.sys_1min_chart.data.datasets[dataset].backgroundColor = this.world.system_colors[system.name];
 
@@ -439,6 +542,8 @@ Vue.component('app-performance-sys-1min-graph', {
       }
 
       app_performance.sys_1min_chart.data.datasets.length = dataset;
+
+      setChartData(this.chart, app_performance.sys_1min_chart, series, "s");
     },
     createChart() {
       const ctx = document.getElementById('sys-1min-graph');
@@ -460,6 +565,102 @@ Vue.component('app-performance-sys-1min-graph', {
     </div>`
 });
 
+Vue.component('app-performance-phase-graph', {
+  props: ['world'],
+  mounted() {
+    this.createChart();
+  },
+  updated() {
+    this.updateChart();
+  },
+  data: function() {
+    return {
+      chart: {}
+    }
+  },
+  methods: {
+    setValues() {
+      var phases = app_performance.phases;
+      var series = [];
+      for (var i = 0; i < phases.length; i ++) {
+        var phase = this.world.phases[phases[i].id];
+
+        if (!app_performance.phase_chart.data.datasets[i]) {
+          app_performance.phase_chart.data.datasets[i] = {
+            label: phases[i].label,
+            borderWidth: 0.5,
+            pointRadius: 0,
+            borderColor: "#000",
+            backgroundColor: colors[(i + 5) % colors.length]
+          }
+        }
+
+        series.push(phase.time_spent_pct.data_1m);
+      }
+
+      setChartData(this.chart, app_performance.phase_chart, series, "s");
+    },
+    createChart() {
+      const ctx = document.getElementById('phase-graph');
+      this.setValues();
+      this.chart = new Chart(ctx, {
+        type: app_performance.phase_chart.type,
+        data: app_performance.phase_chart.data,
+        options: app_performance.phase_chart.options
+      });
+    },
+    updateChart() {
+      this.setValues();
+      this.chart.update(0);
+    }
+  },
+  template: `
+    <div class="app-graph">
+      <canvas id="phase-graph" :data-fps="world.tick"></canvas>
+    </div>`
+});
+
+Vue.component('app-performance-jitter-graph', {
+  props: ['world'],
+  mounted() {
+    this.createChart();
+  },
+  updated() {
+    this.updateChart();
+  },
+  data: function() {
+    return {
+      chart: {}
+    }
+  },
+  methods: {
+    setValues() {
+      setChartData(this.chart, app_performance.jitter_chart, [
+        this.world.frame.data_1m,
+        this.world.frame.ewma_1m,
+        this.world.frame.stddev_1m
+      ], "s");
+    },
+    createChart() {
+      const ctx = document.getElementById('jitter-graph');
+      this.setValues();
+      this.chart = new Chart(ctx, {
+        type: app_performance.jitter_chart.type,
+        data: app_performance.jitter_chart.data,
+        options: app_performance.jitter_chart.options
+      });
+    },
+    updateChart() {
+      this.setValues();
+      this.chart.update(0);
+    }
+  },
+  template: `
+    <div class="app-graph">
+      <canvas id="jitter-graph" :data-fps="world.tick"></canvas>
+    </div>`
+});
+
 Vue.component('app-performance-sys-graph', {
   props: ['world'],
   mounted() {
@@ -521,7 +722,16 @@ Vue.component('app-performance-sys-graph', {
 
 Vue.component('app-performance-system-table', {
   props: ['world'],
+  mixins: [virtual_rows],
+  data: function() {
+    return {
+      sort: "time"
+    }
+  },
   methods: {
+    setSort(sort) {
+      this.sort = sort;
+    },
     enabledColor(system) {
       if (system.is_enabled) {
         if (system.is_active) {
@@ -542,6 +752,10 @@ Vue.component('app-performance-system-table', {
     },
     timeSpent(time) {
       return time.toFixed(2);
+    },
+    requestHistory(system) {
+      request_history(system.name);
+      this.$emit('refresh');
     }
   },
   computed: {
@@ -557,7 +771,19 @@ Vue.component('app-performance-system-table', {
         ...this.world.systems.on_store
       ];
           
-      return arr.sort((el1, el2) => el2.time_spent - el1.time_spent);
+      if (this.sort == "jitter") {
+        return arr.sort((el1, el2) => 
+          el2.time_spent_pct.stddev - el1.time_spent_pct.stddev);
+      } else if (this.sort == "activations") {
+        return arr.sort((el1, el2) => 
+          el2.activation_rate.current - el1.activation_rate.current);
+      } else {
+        return arr.sort((el1, el2) => 
+          el2.time_spent_pct.current - el1.time_spent_pct.current);
+      }
+    },
+    visible_systems: function() {
+      return this.visibleRows(this.sorted_systems);
     }
   },
   template: `
@@ -565,23 +791,30 @@ Vue.component('app-performance-system-table', {
       <div class="app-table-top">
         <h2>systems</h2>
       </div>
-      <div class="app-noscroll-table-content">
+      <div class="app-virtual-table-content" @scroll="onScroll">
         <table class="last_align_right">
           <thead>
             <tr>
               <th>id</th>
               <th>period</th>
-              <th>time</th>
+              <th @click="setSort('time')">time</th>
+              <th @click="setSort('jitter')">jitter</th>
+              <th @click="setSort('activations')">activations</th>
               <th></th>
             </tr>
           </thead>
           <tbody>
-            <tr v-for="system in sorted_systems">
+            <tr v-if="visible_systems.before" :style="{height: visible_systems.before + 'px'}">
+            </tr>
+            <tr v-for="system in visible_systems.rows" :key="system.name">
               <td>
                 <svg height="10" width="10">
                   <circle cx="5" cy="5" r="4" stroke-width="0" :fill="enabledColor(system)"/>
                 </svg>
                 &nbsp;{{system.name}}
+                <span v-if="!system.history" class="app-history-request"
+                  title="Collect history for this system"
+                  @click="requestHistory(system)">+history</span>
               </td>
               <td>
                 <div v-if="system.period != 0">
@@ -594,6 +827,12 @@ Vue.component('app-performance-system-table', {
               <td>
                 {{system.time_spent_pct.current.toFixed(2)}}%
               </td>
+              <td>
+                &plusmn;{{system.time_spent_pct.stddev.toFixed(2)}}%
+              </td>
+              <td>
+                {{system.activation_rate.current.toFixed(2)}}/s
+              </td>
               <td>
                 <app-systems-warning :is_hidden="system.is_hidden">
                 </app-systems-warning>
@@ -605,6 +844,8 @@ Vue.component('app-performance-system-table', {
                 </app-toggle>
               </td>
             </tr>
+            <tr v-if="visible_systems.after" :style="{height: visible_systems.after + 'px'}">
+            </tr>
           </tbody>
         </table>
       </div>
@@ -614,6 +855,20 @@ Vue.component('app-performance-system-table', {
 Vue.component('app-perf-summary', {
   props: ['world'],
   methods: {
+    rate(stat) {
+      if (stat) {
+        return stat.current.toFixed(2) + "/s";
+      } else {
+        return "";
+      }
+    },
+    kb_rate(stat) {
+      if (stat) {
+        return (stat.current / 1024).toFixed(2) + "/s";
+      } else {
+        return "";
+      }
+    },
     set_frame_profiling(el) {
       const Http = new XMLHttpRequest();
       const url = "http://" + host + "/world?frame_profiling=" + el.checked;
@@ -645,6 +900,14 @@ Vue.component('app-perf-summary', {
               <th>Load</th>
               <th>Systems</th>
               <th>Entities</th>
+              <th>Entities/s</th>
+              <th>Tables/s</th>
+              <th>Component churn</th>
+              <th>Table matches/s</th>
+              <th>Overhead</th>
+              <th v-if="world.alloc_tracking">Allocs/s</th>
+              <th v-if="world.alloc_tracking">Alloc KB/s</th>
+              <th v-if="world.alloc_tracking">Frees/s</th>
             </tr>
           </thead>
           <tbody>
@@ -652,6 +915,15 @@ Vue.component('app-perf-summary', {
             <td>{{world.frame.current.toFixed(2)}}%</td>
             <td>{{world.system.current.toFixed(2)}}%</td>
             <td>{{world.entity_count}}</td>
+            <td>{{rate(world.entity_rate)}}</td>
+            <td>{{rate(world.table_rate)}}</td>
+            <td>{{rate(world.component_churn)}}</td>
+            <td>{{rate(world.table_match_rate)}}</td>
+            <td v-if="world.frame_overhead">{{world.frame_overhead.current.toFixed(2)}}%</td>
+            <td v-else></td>
+            <td v-if="world.alloc_tracking">{{rate(world.alloc_rate)}}</td>
+            <td v-if="world.alloc_tracking">{{kb_rate(world.alloc_bytes_rate)}}</td>
+            <td v-if="world.alloc_tracking">{{rate(world.free_rate)}}</td>
           </tbody>
         </table>
       </div>
@@ -703,6 +975,17 @@ Vue.component('app-performance', {
         </div>
       </div>
 
+      <div class="app-fixed-row">
+        <div class="app-left">
+          <app-performance-phase-graph :world="world" v-if="world.phases && world.frame.data_1m.length">
+          </app-performance-phase-graph>
+        </div>
+        <div class="app-right">
+          <app-performance-jitter-graph :world="world" v-if="world.frame.stddev_1m && world.frame.data_1m.length">
+          </app-performance-jitter-graph>
+        </div>
+      </div>
+
       <div class="app-row">
         <app-performance-system-table :world="world"
           :systems="world.systems.on_update"
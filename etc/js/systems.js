@@ -127,12 +127,18 @@ Vue.component('app-systems-system-row', {
 
 Vue.component('app-systems-system-table', {
   props: ['world', 'systems', 'kind'],
+  mixins: [virtual_rows],
+  computed: {
+    visible_systems: function() {
+      return this.visibleRows(this.systems);
+    }
+  },
   template: `
     <div class="app-table">
       <div class="app-table-top">
         <h2>{{kind}} systems</h2>
       </div>
-      <div class="app-noscroll-table-content">
+      <div class="app-virtual-table-content" @scroll="onScroll">
         <table class="last_align_right">
           <thead>
             <tr>
@@ -143,12 +149,16 @@ Vue.component('app-systems-system-table', {
             </tr>
           </thead>
           <tbody>
+            <tr v-if="visible_systems.before" :style="{height: visible_systems.before + 'px'}">
+            </tr>
             <app-systems-system-row
-              v-for="system in systems"
+              v-for="system in visible_systems.rows"
               :key="system.name"
               :system="system"
               v-on:refresh="$emit('refresh', $event)">
             </app-systems-system-row>
+            <tr v-if="visible_systems.after" :style="{height: visible_systems.after + 'px'}">
+            </tr>
           </tbody>
         </table>
       </div>
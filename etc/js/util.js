@@ -0,0 +1,216 @@
+
+// Charts are updated in place. When a series advanced by a few samples since
+// the last update, the oldest points are shifted out and the new points are
+// appended, so that Chart.js only creates elements for the new points. Series
+// that have more points than the chart is wide are downsampled with LTTB.
+
+// Maximum number of samples a series may advance between two updates for the
+// update to be applied as a shift
+var series_max_shift = 8;
+
+// Largest-Triangle-Three-Buckets downsampling. Returns the indices of the
+// points to keep, or undefined when the series does not need downsampling.
+function lttb(data, threshold) {
+  var length = data.length;
+  if (threshold < 3 || threshold >= length) {
+    return undefined;
+  }
+
+  var result = [0];
+  var every = (length - 2) / (threshold - 2);
+  var a = 0;
+
+  for (var i = 0; i < threshold - 2; i ++) {
+    // Average of the next bucket is the third point of the triangle
+    var avg_start = Math.floor((i + 1) * every) + 1;
+    var avg_end = Math.min(Math.floor((i + 2) * every) + 1, length);
+    var avg_x = 0;
+    var avg_y = 0;
+    for (var j = avg_start; j < avg_end; j ++) {
+      avg_x += j;
+      avg_y += data[j];
+    }
+    avg_x /= (avg_end - avg_start);
+    avg_y /= (avg_end - avg_start);
+
+    // Keep the point of the current bucket with the largest triangle
+    var start = Math.floor(i * every) + 1;
+    var end = Math.floor((i + 1) * every) + 1;
+    var max_area = -1;
+    var next = start;
+    for (var j = start; j < end; j ++) {
+      var area = Math.abs(
+        (a - avg_x) * (data[j] - data[a]) - (a - j) * (avg_y - data[a]));
+      if (area > max_area) {
+        max_area = area;
+        next = j;
+      }
+    }
+
+    result.push(next);
+    a = next;
+  }
+
+  result.push(length - 1);
+
+  return result;
+}
+
+// Number of samples data advanced relative to the points of a dataset. The
+// last point may have been updated since, so it is not compared.
+function seriesShift(points, data) {
+  var length = data.length;
+  if (points.length != length) {
+    return 0;
+  }
+
+  for (var shift = 0; shift <= series_max_shift && shift < length; shift ++) {
+    var count = length - shift - 1;
+    var i;
+    for (i = 0; i < count; i ++) {
+      if (points[i + shift] !== data[i]) {
+        break;
+      }
+    }
+    if (i == count) {
+      return shift;
+    }
+  }
+
+  return 0;
+}
+
+// Update the points of a dataset in place
+function setChartSeries(dataset, data, indices) {
+  if (!data) {
+    data = [];
+  }
+
+  if (indices && indices.length) {
+    var sampled = [];
+    for (var i = 0; i < indices.length; i ++) {
+      sampled.push(data[indices[i]]);
+    }
+    data = sampled;
+  }
+
+  var points = dataset.data;
+  if (!points) {
+    dataset.data = data.slice();
+    return;
+  }
+
+  var shift = seriesShift(points, data);
+  if (shift) {
+    points.splice(0, shift);
+  }
+
+  var count = Math.min(points.length, data.length);
+  for (var i = 0; i < count; i ++) {
+    if (points[i] !== data[i]) {
+      points[i] = data[i];
+    }
+  }
+
+  if (points.length > data.length) {
+    points.splice(data.length);
+  } else if (points.length < data.length) {
+    points.push.apply(points, data.slice(points.length));
+  }
+}
+
+// Update the labels and datasets of a chart. Series are assigned to datasets
+// in order. Series of the same length are downsampled the same way, so that
+// stacked series stay aligned. Stacked charts are downsampled on the sum of
+// their series, other charts on their first series.
+function setChartData(chart, config, series, unit) {
+  var length = 0;
+  for (var i = 0; i < series.length; i ++) {
+    if (series[i] && series[i].length > length) {
+      length = series[i].length;
+    }
+  }
+
+  var indices;
+  if (chart && chart.chartArea) {
+    var width = Math.floor(chart.chartArea.right - chart.chartArea.left);
+    var axes = config.options.scales ? config.options.scales.yAxes : undefined;
+    var reference = series[0];
+
+    if (axes && axes[0].stacked) {
+      reference = [];
+      for (var i = 0; i < length; i ++) {
+        var sum = 0;
+        for (var s = 0; s < series.length; s ++) {
+          if (series[s] && series[s].length == length) {
+            sum += series[s][i];
+          }
+        }
+        reference.push(sum);
+      }
+    }
+
+    if (reference && reference.length == length) {
+      indices = lttb(reference, width);
+    }
+  }
+
+  var labels = config.data.labels;
+  var label_count = indices ? indices.length : length;
+  labels.length = label_count;
+  for (var i = 0; i < label_count; i ++) {
+    labels[i] = (length - (indices ? indices[i] : i)) + unit;
+  }
+
+  for (var i = 0; i < series.length; i ++) {
+    var data = series[i];
+    setChartSeries(config.data.datasets[i], data,
+      (data && data.length == length) ? indices : undefined);
+  }
+}
+
+// Height of a table row in pixels, must match the row height in style.css
+var virtual_row_height = 45;
+
+// Rows rendered above and below the visible rows, so that scrolling does not
+// show empty space before the table is rendered again
+var virtual_row_overscan = 5;
+
+// Tables with one row per system can have thousands of rows. Components with
+// this mixin render only the rows that are visible in their scroll container,
+// and pad the table with spacer rows so the scrollbar stays correct.
+var virtual_rows = {
+  data: function() {
+    return {
+      scroll_top: 0,
+      view_height: 540
+    }
+  },
+  methods: {
+    onScroll(e) {
+      this.scroll_top = e.target.scrollTop;
+      this.view_height = e.target.clientHeight;
+    },
+    visibleRows(rows) {
+      if (!rows) {
+        rows = [];
+      }
+
+      var first = Math.floor(this.scroll_top / virtual_row_height);
+      var last = Math.ceil(
+        (this.scroll_top + this.view_height) / virtual_row_height);
+
+      first = Math.max(0, first - virtual_row_overscan);
+      last = Math.min(rows.length, last + virtual_row_overscan);
+      if (first > last) {
+        first = last;
+      }
+
+      return {
+        rows: rows.slice(first, last),
+        before: first * virtual_row_height,
+        after: (rows.length - last) * virtual_row_height
+      };
+    }
+  }
+};
@@ -0,0 +1,65 @@
+
+// Fetches and parses world replies off the main thread. For worlds with many
+// systems parsing the reply takes long enough to drop frames in the dashboard.
+// The worker also computes the activity of systems, which the charts would
+// otherwise compute for each system on every update.
+
+// Time after which a request is abandoned, so a slow server does not stall
+// the dashboard
+var request_timeout = 5000;
+
+function systemActivity(system) {
+  var total = 0;
+  var max = 0;
+  var data = system.time_spent_pct.data_1m;
+  for (var i = 0; i < data.length; i ++) {
+    total += data[i];
+    if (data[i] > max) {
+      max = data[i];
+    }
+  }
+  return {total: total, max: max};
+}
+
+function prepare(world) {
+  if (!world.systems) {
+    return;
+  }
+
+  for (var phase in world.systems) {
+    var systems = world.systems[phase];
+    if (!Array.isArray(systems)) {
+      continue;
+    }
+    for (var i = 0; i < systems.length; i ++) {
+      var system = systems[i];
+      if (system.time_spent_pct && system.time_spent_pct.data_1m) {
+        system.activity_1m = systemActivity(system);
+      }
+    }
+  }
+}
+
+onmessage = function(e) {
+  const Http = new XMLHttpRequest();
+  Http.open("GET", e.data.url);
+  Http.timeout = request_timeout;
+  Http.onreadystatechange = ()=>{
+    if (Http.readyState == 4) {
+      var world;
+
+      // Shed requests (503) are retried on the next refresh
+      if (Http.status == 200 && Http.responseText && Http.responseText.length) {
+        try {
+          world = JSON.parse(Http.responseText);
+          prepare(world);
+        } catch (err) {
+          world = undefined;
+        }
+      }
+
+      postMessage({world: world});
+    }
+  }
+  Http.send();
+}
@@ -0,0 +1,108 @@
+
+// Worlds that are served by the admin. The world that runs the server is served
+// at the root, other worlds are served under worlds/<name>/.
+Vue.component('app-worlds-table', {
+  props: ['worlds'],
+  methods: {
+    toKB(num) {
+      return (num / 1000).toFixed(2) + "KB";
+    },
+    worldPath(w) {
+      if (w.is_owner) {
+        return "";
+      } else {
+        return "worlds/" + w.name + "/";
+      }
+    },
+    rowClass(w) {
+      if (this.worldPath(w) == world_path) {
+        return "app-world-selected";
+      } else {
+        return "";
+      }
+    },
+    select(w) {
+      world_path = this.worldPath(w);
+      app.refresh();
+      this.$forceUpdate();
+    }
+  },
+  template: `
+    <div class="app-table">
+      <div class="app-table-top">
+        <h2>worlds</h2>
+      </div>
+      <div class="app-noscroll-table-content">
+        <table>
+          <thead>
+            <tr>
+              <th>name</th>
+              <th>entities</th>
+              <th>tables</th>
+              <th>systems</th>
+              <th>fps</th>
+              <th>load</th>
+              <th>memory</th>
+            </tr>
+          </thead>
+          <tbody>
+            <tr v-for="w in worlds" :class="rowClass(w)" @click="select(w)">
+              <td>{{w.name}}</td>
+              <td>{{w.entity_count}}</td>
+              <td>{{w.table_count}}</td>
+              <td>{{w.system_count}}</td>
+              <td>{{w.fps.toFixed(2)}} Hz</td>
+              <td>{{w.frame.toFixed(2)}}%</td>
+              <td>{{toKB(w.memory_used)}}</td>
+            </tr>
+          </tbody>
+        </table>
+      </div>
+    </div>`
+});
+
+Vue.component('app-worlds', {
+  props: ['world'],
+  data: function() {
+    return {
+      active: false,
+      worlds: []
+    }
+  },
+  mounted() {
+    setTimeout(function() {
+      this.active = true;
+    }.bind(this), 10);
+    this.requestWorlds();
+  },
+  beforeDestroy() {
+    this.active = false;
+  },
+  watch: {
+    'world.tick': function() {
+      this.requestWorlds();
+    }
+  },
+  methods: {
+    requestWorlds() {
+      const Http = new XMLHttpRequest();
+      const url = "http://" + host + "/worlds";
+      Http.open("GET", url);
+      Http.send();
+      Http.onreadystatechange = (e)=>{
+        if (Http.readyState == 4) {
+          if (Http.responseText && Http.responseText.length) {
+            this.worlds = JSON.parse(Http.responseText);
+          }
+        }
+      }
+    }
+  },
+  template: `
+    <div :class="'app app-active-' + active">
+      <div class="app-row">
+        <app-worlds-table :worlds="worlds">
+        </app-worlds-table>
+      </div>
+    </div>`
+});
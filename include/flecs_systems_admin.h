@@ -9,19 +9,88 @@ extern "C" {
 
 typedef struct EcsAdmin {
     uint16_t port;
+
+    /* Name of the world. Multiple worlds can set EcsAdmin with the same port,
+     * in which case the first world runs the server, and the other worlds are
+     * served under worlds/<name>/. Defaults to "default". */
+    const char *name;
+
+    /* Memory limit in bytes. When set, the admin projects how long it takes
+     * before memory in use reaches the limit, based on its growth. */
+    uint64_t memory_limit;
+
+    /* Count allocations made through the OS API. This wraps the allocation
+     * functions of the OS API for the entire process, and adds a small cost
+     * to each allocation. */
+    bool track_allocs;
+
+    /* Store the history of metrics as float, and memory as float deltas. This
+     * halves the memory used by history, at the cost of precision. */
+    bool compact_history;
 } EcsAdmin;
 
+/* Kinds of application-defined metrics. A gauge is sampled as is, a counter
+ * is sampled as the rate at which it increased since the last sample. */
+typedef enum EcsAdminMetricKind {
+    EcsAdminGauge,
+    EcsAdminCounter
+} EcsAdminMetricKind;
+
+/* Storage for a metric value. The storage is owned by the application, and
+ * must outlive the entity with the EcsAdminMetric component that points to it.
+ * Values are updated with atomic operations, so they can be updated from any
+ * thread without locking or allocating memory. */
+typedef struct ecs_admin_metric_t {
+    volatile int64_t value;
+} ecs_admin_metric_t;
+
+/* Add this component to an entity to show an application-defined metric in
+ * the admin. For example:
+ *
+ * static ecs_admin_metric_t queue_depth;
+ * ecs_set(world, 0, EcsAdminMetric, {
+ *     .name = "queue_depth", .kind = EcsAdminGauge, .metric = &queue_depth});
+ *
+ * ecs_admin_gauge_set(&queue_depth, 10);
+ */
+typedef struct EcsAdminMetric {
+    const char *name;
+    const char *unit;
+    EcsAdminMetricKind kind;
+    ecs_admin_metric_t *metric;
+} EcsAdminMetric;
+
 typedef struct FlecsSystemsAdmin {
    ECS_DECLARE_COMPONENT(EcsAdmin);
+   ECS_DECLARE_COMPONENT(EcsAdminMetric);
 } FlecsSystemsAdmin;
 
+/* Set the value of a gauge */
+FLECS_SYSTEMS_ADMIN_EXPORT
+void ecs_admin_gauge_set(
+    ecs_admin_metric_t *metric,
+    double value);
+
+/* Increase the value of a counter */
+FLECS_SYSTEMS_ADMIN_EXPORT
+void ecs_admin_counter_add(
+    ecs_admin_metric_t *metric,
+    int64_t value);
+
+/* Read the current value of a metric. Counters return their total. */
+FLECS_SYSTEMS_ADMIN_EXPORT
+double ecs_admin_metric_get(
+    ecs_admin_metric_t *metric,
+    EcsAdminMetricKind kind);
+
 FLECS_SYSTEMS_ADMIN_EXPORT
 void FlecsSystemsAdminImport(
     ecs_world_t *world,
     int flags);
 
 #define FlecsSystemsAdminImportHandles(handles)\
-    ECS_IMPORT_COMPONENT(handles, EcsAdmin);
+    ECS_IMPORT_COMPONENT(handles, EcsAdmin);\
+    ECS_IMPORT_COMPONENT(handles, EcsAdminMetric);
 
 #ifdef __cplusplus
 }
@@ -1,17 +1,227 @@
 #include <flecs_systems_admin.h>
 #include "collect.h"
 #include "http.h"
+#include "alloc.h"
+#include "profile.h"
+#include "server.h"
+#include "snapshot.h"
+#include "export.h"
 #include <string.h>
 
 typedef struct http_metrics_t {
-    ecs_entity_t AdminHttpReply;
+    ecs_entity_t reply_system;
+    uint64_t memory_limit;
+    const char *path;           /* Path of endpoint, used in scheduler key */
+    admin_sched_t *sched;       /* NULL for synchronous endpoints */
 } http_metrics_t;
 
 http_metrics_t* http_metrics_ctx(
-    ecs_entity_t AdminHttpReply)
+    ecs_entity_t reply_system,
+    EcsAdmin *admin,
+    const char *path,
+    admin_sched_t *sched)
 {
     http_metrics_t *result = ecs_os_malloc(sizeof(http_metrics_t));
-    result->AdminHttpReply = AdminHttpReply;
+    result->reply_system = reply_system;
+    result->memory_limit = admin->memory_limit;
+    result->path = path;
+    result->sched = sched;
+    return result;
+}
+
+/* Run reply system with the page parameters from the request. When the reply
+ * contains multiple lists, page parameters are prefixed with the list name. */
+static
+bool reply_metrics(
+    ecs_world_t *world,
+    ecs_entity_t reply_system,
+    uint64_t memory_limit,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply,
+    bool prefixed)
+{
+    ecs_strbuf_t reply_body = ECS_STRBUF_INIT;
+
+    const char *params = request->params;
+
+    admin_reply_t reply_params = {
+        .buf = &reply_body,
+        .components = {.sort = AdminSortMemory},
+        .types = {.sort = AdminSortEntities},
+        .tables = {.sort = AdminSortWaste, .limit = 50},
+        .small_table_rows = 4,
+        .memory_limit = memory_limit
+    };
+
+    if (!admin_parse_page(params, prefixed ? "component_" : "", 
+            &reply_params.components) ||
+        !admin_parse_page(params, prefixed ? "type_" : "", 
+            &reply_params.types) ||
+        !admin_parse_page(params, prefixed ? "table_" : "", 
+            &reply_params.tables))
+    {
+        return false;
+    }
+
+    admin_http_param_uint(
+        params, "small_table_rows", &reply_params.small_table_rows);
+
+    char history[256];
+    if (admin_http_param(params, "history", history, sizeof(history))) {
+        reply_params.history = ecs_lookup(world, history);
+    }
+
+    ecs_run(world, reply_system, 0, &reply_params);
+    reply->body = ecs_strbuf_get(&reply_body);
+
+    return reply->body != NULL;
+}
+
+/* Run export system with the selectors and range from the request */
+static
+bool reply_export(
+    ecs_world_t *world,
+    ecs_entity_t export_system,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    admin_export_t export;
+    if (!admin_export_parse(request->params, &export)) {
+        return false;
+    }
+
+    ecs_strbuf_t reply_body = ECS_STRBUF_INIT;
+    export.buf = &reply_body;
+
+    ecs_run(world, export_system, 0, &export);
+
+    /* An export without rows has an empty body */
+    reply->body = ecs_strbuf_get(&reply_body);
+    if (!reply->body) {
+        reply->body = ecs_os_calloc(1, 1);
+    }
+
+    /* Rows that did not fit in the page are requested with the cursor */
+    char cursor[ADMIN_EXPORT_CURSOR_SIZE];
+    if (admin_export_cursor(&export, cursor, sizeof(cursor))) {
+        ecs_strbuf_t header = ECS_STRBUF_INIT;
+        ecs_strbuf_append(&header, "X-Export-Cursor: %s\r\n", cursor);
+        reply->header = ecs_strbuf_get(&header);
+    }
+
+    return true;
+}
+
+/* Requests with the same endpoint, url and parameters produce the same reply,
+ * so they are coalesced by the scheduler */
+static
+char* request_key(
+    const char *path,
+    EcsHttpRequest *request)
+{
+    ecs_strbuf_t key = ECS_STRBUF_INIT;
+    ecs_strbuf_append(&key, "%s/%s?%s", path, 
+        request->relative_url ? request->relative_url : "",
+        request->params ? request->params : "");
+    return ecs_strbuf_get(&key);
+}
+
+/* Reply for a request that a world did not run in time */
+static
+bool reply_timeout(
+    EcsHttpReply *reply)
+{
+    const char *body = "{\"error\":\"world did not reply\"}";
+    size_t len = strlen(body) + 1;
+
+    reply->status = 504;
+    reply->body = ecs_os_malloc(len);
+    memcpy(reply->body, body, len);
+
+    return true;
+}
+
+/* Convert result of a request that was posted to a world to an endpoint result */
+static
+bool reply_world_result(
+    admin_world_result_t result,
+    EcsHttpReply *reply)
+{
+    if (result == AdminWorldTimeout) {
+        return reply_timeout(reply);
+    }
+
+    return result == AdminWorldOk;
+}
+
+/* Request for statistics of a world, serialized by the scheduler */
+typedef struct metrics_request_t {
+    ecs_world_t *world;
+    ecs_entity_t reply_system;
+    uint64_t memory_limit;
+    EcsHttpRequest *request;
+    EcsHttpReply *reply;
+    bool prefixed;
+    bool export;
+} metrics_request_t;
+
+/* Runs on the thread of the world */
+static
+bool reply_metrics_request(
+    admin_world_t *w,
+    void *ctx)
+{
+    metrics_request_t *r = ctx;
+
+    if (r->export) {
+        return reply_export(r->world, r->reply_system, r->request, r->reply);
+    } else {
+        return reply_metrics(r->world, r->reply_system, r->memory_limit, 
+            r->request, r->reply, r->prefixed);
+    }
+}
+
+/* Asynchronous endpoints run on HTTP threads, so the request is posted to the
+ * world that runs the server, like requests for other worlds */
+static
+bool run_metrics_request(
+    void *ctx,
+    EcsHttpReply *reply)
+{
+    metrics_request_t *r = ctx;
+    r->reply = reply;
+    return reply_world_result(
+        admin_server_run_world(r->world, reply_metrics_request, r), reply);
+}
+
+/* Reply with statistics. Synchronous endpoints already run one at a time on
+ * the main thread, and are not scheduled. */
+static
+bool schedule_metrics(
+    ecs_world_t *world,
+    http_metrics_t *ctx,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply,
+    bool prefixed)
+{
+    metrics_request_t r = {
+        .world = world,
+        .reply_system = ctx->reply_system,
+        .memory_limit = ctx->memory_limit,
+        .request = request,
+        .prefixed = prefixed
+    };
+
+    if (!ctx->sched) {
+        r.reply = reply;
+        return reply_metrics_request(NULL, &r);
+    }
+
+    char *key = request_key(ctx->path, request);
+    bool result = admin_sched_run(
+        ctx->sched, key, run_metrics_request, &r, reply);
+    ecs_os_free(key);
+
     return result;
 }
 
@@ -48,7 +258,242 @@ bool request_files(
     return true;
 }
 
-/* HTTP endpoint that enables/disables systems */
+/* Context of the systems endpoint */
+typedef struct http_systems_t {
+    ecs_entity_t collect_system;
+    float collect_period;
+} http_systems_t;
+
+/* Change to a system requested by a client */
+typedef struct system_change_t {
+    ecs_entity_t system;
+    int8_t enable;      /* -1 if unchanged, 0 to disable, 1 to enable */
+    bool set_period;
+    float period;
+} system_change_t;
+
+static
+const ecs_vector_params_t change_params = {
+    .element_size = sizeof(system_change_t)
+};
+
+http_systems_t* http_systems_ctx(
+    ecs_entity_t collect_system)
+{
+    http_systems_t *result = ecs_os_malloc(sizeof(http_systems_t));
+    result->collect_system = collect_system;
+    result->collect_period = ADMIN_COLLECT_PERIOD;
+    return result;
+}
+
+/* Find or add the change for a system, so that a system that is listed more
+ * than once in a request only appears once in the reply */
+static
+system_change_t* find_change(
+    ecs_vector_t **changes,
+    ecs_entity_t system)
+{
+    system_change_t *buffer = ecs_vector_first(*changes);
+    uint32_t i, count = ecs_vector_count(*changes);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i].system == system) {
+            return &buffer[i];
+        }
+    }
+
+    system_change_t *change = ecs_vector_add(changes, &change_params);
+    change->system = system;
+    change->enable = -1;
+    change->set_period = false;
+    change->period = 0;
+
+    return change;
+}
+
+/* Parse comma separated list of systems to enable or disable */
+static
+bool parse_enable(
+    ecs_world_t *world,
+    char *list,
+    bool enable,
+    ecs_vector_t **changes)
+{
+    char *name = list;
+    while (name && *name) {
+        char *next = strchr(name, ',');
+        if (next) {
+            *next = '\0';
+            next ++;
+        }
+
+        ecs_entity_t system = ecs_lookup(world, name);
+        if (!system) {
+            ecs_os_err("admin: system '%s' not found", name);
+            return false;
+        }
+
+        find_change(changes, system)->enable = enable;
+        name = next;
+    }
+
+    return true;
+}
+
+/* Parse comma separated list of system:period pairs */
+static
+bool parse_periods(
+    ecs_world_t *world,
+    char *list,
+    ecs_vector_t **changes)
+{
+    char *name = list;
+    while (name && *name) {
+        char *next = strchr(name, ',');
+        if (next) {
+            *next = '\0';
+            next ++;
+        }
+
+        char *sep = strchr(name, ':');
+        if (!sep) {
+            ecs_os_err("admin: missing period for system '%s'", name);
+            return false;
+        }
+
+        *sep = '\0';
+
+        char *end;
+        double period = strtod(sep + 1, &end);
+        if (end == sep + 1 || *end || period < 0) {
+            ecs_os_err("admin: invalid period for system '%s'", name);
+            return false;
+        }
+
+        ecs_entity_t system = ecs_lookup(world, name);
+        if (!system) {
+            ecs_os_err("admin: system '%s' not found", name);
+            return false;
+        }
+
+        system_change_t *change = find_change(changes, system);
+        change->set_period = true;
+        change->period = period;
+        name = next;
+    }
+
+    return true;
+}
+
+/* Parse the changes of a request. All changes are parsed before any of them is
+ * applied, so that a request with an invalid parameter changes nothing. */
+static
+bool parse_changes(
+    ecs_world_t *world,
+    EcsHttpRequest *request,
+    ecs_vector_t **changes,
+    float *collect_period)
+{
+    const char *params = request->params;
+    char list[4096];
+
+    /* Legacy format, which changes a single system: systems/<name>?enabled= */
+    if (request->relative_url && strlen(request->relative_url)) {
+        ecs_entity_t system = ecs_lookup(world, request->relative_url);
+        if (!system) {
+            return false;
+        }
+
+        system_change_t *change = find_change(changes, system);
+        if (admin_http_param(params, "enabled", list, sizeof(list))) {
+            if (!strcmp(list, "true")) {
+                change->enable = 1;
+            } else if (!strcmp(list, "false")) {
+                change->enable = 0;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    if (admin_http_param(params, "enable", list, sizeof(list))) {
+        if (!parse_enable(world, list, true, changes)) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "disable", list, sizeof(list))) {
+        if (!parse_enable(world, list, false, changes)) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "period", list, sizeof(list))) {
+        if (!parse_periods(world, list, changes)) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "collect_period", list, sizeof(list))) {
+        char *end;
+        double period = strtod(list, &end);
+        if (end == list || *end || period <= 0) {
+            ecs_os_err("admin: invalid collection period '%s'", list);
+            return false;
+        }
+
+        *collect_period = period;
+    }
+
+    return true;
+}
+
+static
+void apply_change(
+    ecs_world_t *world,
+    system_change_t *change)
+{
+    const char *id = ecs_get_id(world, change->system);
+
+    if (change->enable != -1) {
+        ecs_os_dbg("admin: %s system %s", 
+            change->enable ? "enable" : "disable", id);
+        ecs_enable(world, change->system, change->enable);
+    }
+
+    if (change->set_period) {
+        ecs_os_dbg("admin: set period of system %s to %f", id, change->period);
+        ecs_set_period(world, change->system, change->period);
+    }
+}
+
+static
+void write_change(
+    ecs_world_t *world,
+    system_change_t *change,
+    ecs_strbuf_t *reply)
+{
+    ecs_strbuf_list_next(reply);
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_append(reply, "\"name\":\"%s\"", 
+        ecs_get_id(world, change->system));
+    ecs_strbuf_list_append(reply, "\"is_enabled\":%s", 
+        ecs_is_enabled(world, change->system) ? "true" : "false");
+    if (change->set_period) {
+        ecs_strbuf_list_append(reply, "\"period\":%f", change->period);
+    }
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+/* HTTP endpoint that enables/disables systems and changes their period. A
+ * single request can change multiple systems, with the parameters:
+ *   enable=A,B          enable systems A and B
+ *   disable=C           disable system C
+ *   period=A:0.5,C:0    run A every 0.5 seconds, and C every frame
+ *   collect_period=2    collect admin statistics every 2 seconds
+ * 
+ * Changes are applied between frames, as the endpoint runs on the main thread.
+ * The reply contains the resulting state of the systems in the request. */
 static
 bool request_systems(
     ecs_world_t *world,
@@ -57,25 +502,49 @@ bool request_systems(
     EcsHttpRequest *request,
     EcsHttpReply *reply)
 {
-    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    http_systems_t *ctx = endpoint->ctx;
+    ecs_vector_t *changes = ecs_vector_new(&change_params, 0);
+    float collect_period = ctx->collect_period;
 
-    ecs_entity_t system = ecs_lookup(world, request->relative_url);
-    if (!system) {
+    if (!parse_changes(world, request, &changes, &collect_period)) {
+        ecs_vector_free(changes);
         return false;
     }
 
+    system_change_t *buffer = ecs_vector_first(changes);
+    uint32_t i, count = ecs_vector_count(changes);
+
     if (request->method == EcsHttpPost) {
-        if (!strcmp(request->params, "enabled=false")) {
-            ecs_os_dbg("admin: disable system %s", ecs_get_id(world, system));
-            ecs_enable(world, system, false);
-        } else if (!strcmp(request->params, "enabled=true")) {
-            ecs_os_dbg("admin: enable system %s", ecs_get_id(world, system));
-            ecs_enable(world, system, true);
+        for (i = 0; i < count; i ++) {
+            apply_change(world, &buffer[i]);
         }
+
+        if (collect_period != ctx->collect_period) {
+            ecs_os_dbg("admin: set collection period to %f", collect_period);
+            ecs_set_period(world, ctx->collect_system, collect_period);
+            ctx->collect_period = collect_period;
+        }
+    } else if (count || collect_period != ctx->collect_period) {
+        /* Only POST requests can change systems */
+        ecs_vector_free(changes);
+        return false;
+    }
+
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    ecs_strbuf_list_push(&body, "{", ",");
+    ecs_strbuf_list_append(&body, "\"collect_period\":%f", ctx->collect_period);
+    ecs_strbuf_list_appendstr(&body, "\"systems\":");
+    ecs_strbuf_list_push(&body, "[", ",");
+    for (i = 0; i < count; i ++) {
+        write_change(world, &buffer[i], &body);
     }
+    ecs_strbuf_list_pop(&body, "]");
+    ecs_strbuf_list_pop(&body, "}");
 
     reply->body = ecs_strbuf_get(&body);
 
+    ecs_vector_free(changes);
+
     return true;
 }
 
@@ -88,17 +557,335 @@ bool request_world(
     EcsHttpRequest *request,
     EcsHttpReply *reply)
 {
+    http_metrics_t *ctx = endpoint->ctx;
+
+    if (request->method == EcsHttpGet) {
+        return schedule_metrics(world, ctx, request, reply, true);
+    } else {
+        return false;
+    }
+}
+
+/* HTTP endpoint that returns a page of component, type or table statistics.
+ * Pages are selected with the sort, limit and cursor parameters. */
+static
+bool request_list(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    http_metrics_t *ctx = endpoint->ctx;
+
     if (request->method == EcsHttpGet) {
-        ecs_strbuf_t reply_body = ECS_STRBUF_INIT;
-        http_metrics_t *ctx = endpoint->ctx;
+        return schedule_metrics(world, ctx, request, reply, false);
+    } else {
+        return false;
+    }
+}
+
+/* HTTP endpoint that exports the history of selected metrics as NDJSON or CSV.
+ * Metrics are selected with the metric parameter, and the range with the from
+ * and to parameters. */
+static
+bool request_export(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    http_metrics_t *ctx = endpoint->ctx;
+
+    if (request->method != EcsHttpGet) {
+        return false;
+    }
+
+    metrics_request_t r = {
+        .world = world,
+        .reply_system = ctx->reply_system,
+        .request = request,
+        .export = true
+    };
+
+    char *key = request_key(ctx->path, request);
+    bool result = admin_sched_run(
+        ctx->sched, key, run_metrics_request, &r, reply);
+    ecs_os_free(key);
 
-        ecs_run(world, ctx->AdminHttpReply, 0, &reply_body);
+    return result;
+}
+
+/* Request for statistics of a world registered with the server */
+typedef struct world_request_t {
+    admin_server_t *server;
+    EcsHttpRequest *request;
+    EcsHttpReply *reply;
+    const char *name;
+    const char *path;
+} world_request_t;
+
+/* Runs on the thread of the requested world */
+static
+bool reply_world_request(
+    admin_world_t *w,
+    void *ctx)
+{
+    world_request_t *r = ctx;
+    const char *path = r->path;
+    EcsHttpRequest *request = r->request;
+    EcsHttpReply *reply = r->reply;
+    bool result = false;
 
-        reply->body = ecs_strbuf_get(&reply_body);
+    if (!strcmp(path, "world")) {
+        result = reply_metrics(
+            w->world, w->reply, w->memory_limit, request, reply, true);
+    } else if (!strcmp(path, "components")) {
+        result = reply_metrics(
+            w->world, w->reply_components, w->memory_limit, request, reply, false);
+    } else if (!strcmp(path, "types")) {
+        result = reply_metrics(
+            w->world, w->reply_types, w->memory_limit, request, reply, false);
+    } else if (!strcmp(path, "tables")) {
+        result = reply_metrics(
+            w->world, w->reply_tables, w->memory_limit, request, reply, false);
+    } else if (!strcmp(path, "export")) {
+        result = reply_export(w->world, w->reply_export, request, reply);
+    }
+
+    return result;
+}
+
+static
+bool run_world_request(
+    void *ctx,
+    EcsHttpReply *reply)
+{
+    world_request_t *r = ctx;
+    r->reply = reply;
+    return reply_world_result(
+        admin_server_run(r->server, r->name, reply_world_request, r), reply);
+}
+
+/* HTTP endpoint that serves the worlds registered with the server. Without a
+ * relative url, the endpoint returns a summary of all worlds. Statistics of a
+ * single world are requested with <name>/world, <name>/components,
+ * <name>/types, <name>/tables and <name>/export, which accept the same parameters as the
+ * endpoints of the world that runs the server. */
+static
+bool request_worlds(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    admin_server_t *server = endpoint->ctx;
+    const char *url = request->relative_url;
+
+    if (request->method != EcsHttpGet) {
+        return false;
+    }
+
+    if (!url || !strlen(url)) {
+        ecs_strbuf_t body = ECS_STRBUF_INIT;
+        admin_server_summary(server, &body);
+        reply->body = ecs_strbuf_get(&body);
+        return reply->body != NULL;
+    }
+
+    const char *sep = strchr(url, '/');
+    if (!sep) {
+        return false;
+    }
+
+    char name[128];
+    size_t name_len = sep - url;
+    if (name_len >= sizeof(name)) {
+        return false;
+    }
+
+    memcpy(name, url, name_len);
+    name[name_len] = '\0';
+
+    world_request_t r = {
+        .server = server,
+        .request = request,
+        .name = name,
+        .path = sep + 1
+    };
+
+    char *key = request_key("worlds", request);
+    bool result = admin_sched_run(
+        admin_server_sched(server), key, run_world_request, &r, reply);
+    ecs_os_free(key);
+
+    return result;
+}
+
+/* HTTP endpoint that manages snapshots. GET returns the list of snapshots, a
+ * POST to snapshots/<name> captures a snapshot, and a DELETE to
+ * snapshots/<name> removes it. */
+static
+bool request_snapshots(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    admin_snapshot_store_t *store = endpoint->ctx;
+    const char *name = request->relative_url;
+
+    if (request->method == EcsHttpPost) {
+        if (!name || !strlen(name) || strlen(name) >= ADMIN_SNAPSHOT_NAME_SIZE) {
+            return false;
+        }
+
+        admin_snapshot_t *snapshot = admin_snapshot_capture(world, store, name);
+        if (!admin_snapshot_store(store, snapshot)) {
+            ecs_os_err("admin: cannot store more than %d snapshots", 
+                ADMIN_SNAPSHOT_MAX);
+            admin_snapshot_free(snapshot);
+            return false;
+        }
+
+        ecs_os_dbg("admin: captured snapshot '%s'", name);
+    } else if (request->method == EcsHttpDelete) {
+        if (!name || !admin_snapshot_remove(store, name)) {
+            return false;
+        }
+    } else if (request->method != EcsHttpGet) {
+        return false;
+    }
+
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    admin_snapshot_list(store, &body);
+    reply->body = ecs_strbuf_get(&body);
+
+    return true;
+}
+
+/* HTTP endpoint that compares two snapshots. The from parameter specifies the
+ * baseline, and the optional to parameter the snapshot it is compared with.
+ * Without to, the baseline is compared with the current statistics. */
+static
+bool request_diff(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    admin_snapshot_store_t *store = endpoint->ctx;
+    const char *params = request->params;
+    char from_name[ADMIN_SNAPSHOT_NAME_SIZE], to_name[ADMIN_SNAPSHOT_NAME_SIZE];
+    char value[32];
+
+    if (request->method != EcsHttpGet) {
+        return false;
+    }
+
+    if (!admin_http_param(params, "from", from_name, sizeof(from_name))) {
+        return false;
+    }
+
+    admin_snapshot_t *from = admin_snapshot_find(store, from_name);
+    if (!from) {
+        return false;
+    }
+
+    admin_diff_params_t diff_params = {
+        .relative = true,
+        .kind = -1,
+        .limit = 50
+    };
+
+    if (admin_http_param(params, "sort", value, sizeof(value))) {
+        if (!strcmp(value, "absolute")) {
+            diff_params.relative = false;
+        } else if (strcmp(value, "relative")) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "kind", value, sizeof(value))) {
+        if (!strcmp(value, "world")) {
+            diff_params.kind = AdminSnapshotWorld;
+        } else if (!strcmp(value, "memory")) {
+            diff_params.kind = AdminSnapshotMemory;
+        } else if (!strcmp(value, "system")) {
+            diff_params.kind = AdminSnapshotSystem;
+        } else if (!strcmp(value, "component")) {
+            diff_params.kind = AdminSnapshotComponent;
+        } else {
+            return false;
+        }
+    }
+
+    admin_http_param_uint(params, "limit", &diff_params.limit);
+    admin_http_param_uint(params, "cursor", &diff_params.cursor);
+
+    admin_snapshot_t *to, *now = NULL;
+    if (admin_http_param(params, "to", to_name, sizeof(to_name))) {
+        to = admin_snapshot_find(store, to_name);
+        if (!to) {
+            return false;
+        }
     } else {
+        to = now = admin_snapshot_capture(world, store, "now");
+    }
+
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    admin_snapshot_diff(world, from, to, &diff_params, &body);
+    reply->body = ecs_strbuf_get(&body);
+
+    if (now) {
+        admin_snapshot_free(now);
+    }
+
+    return true;
+}
+
+/* HTTP endpoint that samples the process, and returns collapsed stacks. The
+ * sample rate (in Hz) and duration (in seconds) can be set with the rate and
+ * duration parameters. */
+static
+bool request_profile(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    EcsHttpEndpoint *endpoint,
+    EcsHttpRequest *request,
+    EcsHttpReply *reply)
+{
+    http_metrics_t *ctx = endpoint->ctx;
+
+    if (request->method != EcsHttpGet || !admin_profile_supported()) {
+        return false;
+    }
+
+    uint32_t rate = ADMIN_PROFILE_DEFAULT_RATE;
+    uint32_t duration = ADMIN_PROFILE_DEFAULT_DURATION;
+    admin_http_param_uint(request->params, "rate", &rate);
+    admin_http_param_uint(request->params, "duration", &duration);
+
+    ecs_strbuf_t body = ECS_STRBUF_INIT;
+    uint32_t dropped = 0;
+
+    if (!admin_profile_run(
+        world, ctx->reply_system, rate, duration, &body, &dropped)) 
+    {
+        ecs_os_warn("admin: profiler is busy");
         return false;
     }
 
+    if (dropped) {
+        ecs_os_warn("admin: profiler dropped %u samples", dropped);
+    }
+
+    reply->body = ecs_strbuf_get(&body);
+
     return true;
 }
 
@@ -109,26 +896,167 @@ void EcsAdminStart(ecs_rows_t *rows) {
     EcsAdmin *admin = ecs_column(rows, EcsAdmin, 1);
     ECS_IMPORT_COLUMN(rows, FlecsComponentsHttp, 2);
     ECS_COLUMN_ENTITY(rows, AdminHttpReply, 3);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyComponents, 4);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyTypes, 5);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyTables, 6);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplySummary, 7);
+    ECS_COLUMN_ENTITY(rows, AdminCollectMetrics, 8);
+    ECS_COLUMN_ENTITY(rows, AdminSnapshotCapture, 9);
+    ECS_COLUMN_COMPONENT(rows, AdminCollectConfig, 10);
+    ECS_COLUMN_COMPONENT(rows, EcsAdminMetric, 11);
+    ECS_COLUMN_ENTITY(rows, AdminExportHistory, 12);
+    ECS_COLUMN_ENTITY(rows, AdminProfileSystems, 13);
 
     int i;
     for (i = 0; i < rows->count; i ++) {
         ecs_entity_t server = rows->entities[i];
+        const char *name = admin[i].name ? admin[i].name : "default";
+
+        /* Applies to history that is allocated after this point */
+        ecs_set(world, AdminCollectMetrics, AdminCollectConfig, {
+            .compact_history = admin[i].compact_history
+        });
+
+        bool is_owner;
+        admin_server_t *admin_server = admin_server_register(admin[i].port, 
+            &(admin_world_t){
+                .name = (char*)name,
+                .world = world,
+                .reply = AdminHttpReply,
+                .reply_components = AdminHttpReplyComponents,
+                .reply_types = AdminHttpReplyTypes,
+                .reply_tables = AdminHttpReplyTables,
+                .reply_summary = AdminHttpReplySummary,
+                .reply_export = AdminExportHistory,
+                .memory_limit = admin[i].memory_limit,
+                .track_allocs = admin[i].track_allocs
+            }, &is_owner);
+
+        if (!admin_server) {
+            ecs_os_err("admin: world '%s' already registered on :%u", 
+                name, admin[i].port);
+            continue;
+        }
+
+        /* Disabled again when the world is unregistered */
+        if (admin[i].track_allocs) {
+            admin_alloc_enable();
+        }
+
+        /* Another world already runs the server for this port */
+        if (!is_owner) {
+            ecs_os_log("admin: world '%s' served on :%u/worlds/%s", 
+                name, admin[i].port, name);
+            continue;
+        }
 
         ecs_set(world, server, EcsHttpServer, {.port = admin[i].port});
+
+        /* Requests shed and coalesced by the scheduler of the server */
+        admin_sched_t *sched = admin_server_sched(admin_server);
+          ecs_entity_t e_shed = ecs_new_child(world, server, 0);
+            ecs_set(world, e_shed, EcsAdminMetric, {
+                .name = "admin_requests_shed",
+                .unit = "req",
+                .kind = EcsAdminCounter,
+                .metric = admin_sched_shed(sched) });
+
+          ecs_entity_t e_coalesced = ecs_new_child(world, server, 0);
+            ecs_set(world, e_coalesced, EcsAdminMetric, {
+                .name = "admin_requests_coalesced",
+                .unit = "req",
+                .kind = EcsAdminCounter,
+                .metric = admin_sched_coalesced(sched) });
+
           ecs_entity_t e_world = ecs_new_child(world, server, 0);
             ecs_set(world, e_world, EcsHttpEndpoint, {
                 .url = "world",
                 .action = request_world,
-                .ctx = http_metrics_ctx(AdminHttpReply),
+                .ctx = http_metrics_ctx(AdminHttpReply, &admin[i], 
+                    "world", sched),
                 .synchronous = false 
             });
 
+          ecs_entity_t e_components = ecs_new_child(world, server, 0);
+            ecs_set(world, e_components, EcsHttpEndpoint, {
+                .url = "components",
+                .action = request_list,
+                .ctx = http_metrics_ctx(AdminHttpReplyComponents, &admin[i], 
+                    "components", sched),
+                .synchronous = false 
+            });
+
+          ecs_entity_t e_types = ecs_new_child(world, server, 0);
+            ecs_set(world, e_types, EcsHttpEndpoint, {
+                .url = "types",
+                .action = request_list,
+                .ctx = http_metrics_ctx(AdminHttpReplyTypes, &admin[i], 
+                    "types", sched),
+                .synchronous = false 
+            });
+
+          /* Table statistics walk all tables, so run on the main thread */
+          ecs_entity_t e_tables = ecs_new_child(world, server, 0);
+            ecs_set(world, e_tables, EcsHttpEndpoint, {
+                .url = "tables",
+                .action = request_list,
+                .ctx = http_metrics_ctx(AdminHttpReplyTables, &admin[i], 
+                    "tables", NULL),
+                .synchronous = true 
+            });
+
           ecs_entity_t e_systems = ecs_new_child(world, server, 0);
             ecs_set(world, e_systems, EcsHttpEndpoint, {
                 .url = "systems",
                 .action = request_systems,
+                .ctx = http_systems_ctx(AdminCollectMetrics),
+                .synchronous = true });
+
+          /* Snapshots are captured and compared on the main thread, so that
+           * they are consistent, and so the store is not accessed by multiple
+           * threads */
+          admin_snapshot_store_t *snapshots = 
+              admin_snapshot_store_new(AdminSnapshotCapture);
+
+          ecs_entity_t e_snapshots = ecs_new_child(world, server, 0);
+            ecs_set(world, e_snapshots, EcsHttpEndpoint, {
+                .url = "snapshots",
+                .action = request_snapshots,
+                .ctx = snapshots,
+                .synchronous = true });
+
+          ecs_entity_t e_diff = ecs_new_child(world, server, 0);
+            ecs_set(world, e_diff, EcsHttpEndpoint, {
+                .url = "diff",
+                .action = request_diff,
+                .ctx = snapshots,
                 .synchronous = true });
 
+          ecs_entity_t e_export = ecs_new_child(world, server, 0);
+            ecs_set(world, e_export, EcsHttpEndpoint, {
+                .url = "export",
+                .action = request_export,
+                .ctx = http_metrics_ctx(AdminExportHistory, &admin[i], 
+                    "export", sched),
+                .synchronous = false });
+
+          ecs_entity_t e_worlds = ecs_new_child(world, server, 0);
+            ecs_set(world, e_worlds, EcsHttpEndpoint, {
+                .url = "worlds",
+                .action = request_worlds,
+                .ctx = admin_server,
+                .synchronous = false });
+
+          /* The profiler blocks for the duration of the profile, so it must
+           * not run on the main thread */
+          ecs_entity_t e_profile = ecs_new_child(world, server, 0);
+            ecs_set(world, e_profile, EcsHttpEndpoint, {
+                .url = "profile",
+                .action = request_profile,
+                .ctx = http_metrics_ctx(AdminProfileSystems, &admin[i], 
+                    "profile", NULL),
+                .synchronous = false });
+
           ecs_entity_t e_files = ecs_new_child(world, server, 0);
             ecs_set(world, e_files, EcsHttpEndpoint, {
                 .url = "",
@@ -139,6 +1067,22 @@ void EcsAdminStart(ecs_rows_t *rows) {
     }
 }
 
+/* Requests for this world from the servers it is registered with run here, on
+ * the thread of the world, so that they do not race with the world's systems */
+static
+void EcsAdminServe(ecs_rows_t *rows) {
+    admin_server_dispatch(rows->world);
+}
+
+/* Unregister world from admin server */
+static
+void EcsAdminStop(ecs_rows_t *rows) {
+    uint32_t tracking = admin_server_unregister(rows->world);
+    while (tracking --) {
+        admin_alloc_disable();
+    }
+}
+
 void FlecsSystemsAdminImport(
     ecs_world_t *world,
     int flags)
@@ -146,9 +1090,16 @@ void FlecsSystemsAdminImport(
     /* Import HTTP components */
     ECS_IMPORT(world, FlecsComponentsHttp, 0);
 
+    /* Register metric component before private imports, as the private
+     * modules collect and serialize application-defined metrics */
+    ECS_COMPONENT(world, EcsAdminMetric);
+
     /* Private imports */
-    ECS_IMPORT(world, AdminCollect, 0); /* Collect derivative statistics */
-    ECS_IMPORT(world, AdminHttp, 0);    /* Systems that produce HTTP reply */
+    ECS_IMPORT(world, AdminCollect, 0);  /* Collect derivative statistics */
+    ECS_IMPORT(world, AdminHttp, 0);     /* Systems that produce HTTP reply */
+    ECS_IMPORT(world, AdminSnapshot, 0); /* Baseline snapshots of statistics */
+    ECS_IMPORT(world, AdminExport, 0);   /* Export history of metrics */
+    ECS_IMPORT(world, AdminProfile, 0);  /* Systems on sampled stacks */
 
     ECS_MODULE(world, FlecsSystemsAdmin);
 
@@ -158,7 +1109,24 @@ void FlecsSystemsAdminImport(
     /* Start admin server when an EcsAdmin component has been initialized */
     ECS_SYSTEM(world, EcsAdminStart, EcsOnSet, EcsAdmin, $.FlecsComponentsHttp, 
         .AdminHttpReply,
+        .AdminHttpReplyComponents,
+        .AdminHttpReplyTypes,
+        .AdminHttpReplyTables,
+        .AdminHttpReplySummary,
+        .AdminCollectMetrics,
+        .AdminSnapshotCapture,
+        .AdminCollectConfig,
+        .EcsAdminMetric,
+        .AdminExportHistory,
+        .AdminProfileSystems,
         SYSTEM.EcsHidden);
 
+    /* Run requests that other threads posted for this world */
+    ECS_SYSTEM(world, EcsAdminServe, EcsOnStore, EcsAdmin, SYSTEM.EcsHidden);
+
+    /* Stop serving world when the EcsAdmin component is removed */
+    ECS_SYSTEM(world, EcsAdminStop, EcsOnRemove, EcsAdmin, SYSTEM.EcsHidden);
+
     ECS_EXPORT_COMPONENT(EcsAdmin);
+    ECS_EXPORT_COMPONENT(EcsAdminMetric);
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include <flecs_systems_admin.h>
+#include "alloc.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#include <malloc.h>
+#define ADMIN_THREAD_LOCAL __declspec(thread)
+#define admin_alloc_size(ptr) _msize(ptr)
+#else
+#define ADMIN_THREAD_LOCAL __thread
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define admin_alloc_size(ptr) malloc_size(ptr)
+#elif defined(__linux__)
+#include <malloc.h>
+#define admin_alloc_size(ptr) malloc_usable_size(ptr)
+#else
+#define admin_alloc_size(ptr) (0)
+#endif
+#endif
+
+typedef struct admin_alloc_counter_t {
+    volatile uint64_t alloc_count;
+    volatile uint64_t alloc_bytes;
+    volatile uint64_t free_count;
+    struct admin_alloc_counter_t *next;
+} admin_alloc_counter_t;
+
+/* Original OS API functions */
+static ecs_os_api_malloc_t prev_malloc;
+static ecs_os_api_realloc_t prev_realloc;
+static ecs_os_api_calloc_t prev_calloc;
+static ecs_os_api_free_t prev_free;
+
+/* Hooks are installed while at least one world tracks allocations. The lock
+ * is only held while the hooks are installed or removed, so it spins instead
+ * of blocking. */
+static volatile int32_t hooks_lock;
+static volatile int32_t tracking_enabled;
+static uint32_t tracking_count;
+
+/* List with counters of all threads. Counters are never freed, as threads may
+ * exit while the collector reads them. */
+static admin_alloc_counter_t * volatile counters;
+
+static ADMIN_THREAD_LOCAL admin_alloc_counter_t *thread_counter;
+
+static
+void counter_store(
+    volatile uint64_t *ptr,
+    uint64_t value)
+{
+#ifdef _MSC_VER
+    InterlockedExchange64((volatile LONG64*)ptr, value);
+#else
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static
+uint64_t counter_load(
+    volatile uint64_t *ptr)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange64((volatile LONG64*)ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+#endif
+}
+
+/* Set flag, returns true if the flag was not yet set */
+static
+bool flag_set(
+    volatile int32_t *flag)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange((volatile LONG*)flag, 1, 0) == 0;
+#else
+    int32_t expected = 0;
+    return __atomic_compare_exchange_n(
+        flag, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+}
+
+static
+void flag_clear(
+    volatile int32_t *flag)
+{
+#ifdef _MSC_VER
+    InterlockedExchange((volatile LONG*)flag, 0);
+#else
+    __atomic_store_n(flag, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+static
+bool flag_get(
+    volatile int32_t *flag)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange((volatile LONG*)flag, 0, 0) != 0;
+#else
+    return __atomic_load_n(flag, __ATOMIC_RELAXED) != 0;
+#endif
+}
+
+/* Register counter for the current thread. This only happens on the first
+ * allocation of a thread. */
+static
+admin_alloc_counter_t* counter_register(void)
+{
+    admin_alloc_counter_t *counter = prev_calloc(1, sizeof(admin_alloc_counter_t));
+    if (!counter) {
+        return NULL;
+    }
+
+    admin_alloc_counter_t *head;
+    do {
+        head = counters;
+        counter->next = head;
+#ifdef _MSC_VER
+    } while (InterlockedCompareExchangePointer(
+        (PVOID volatile*)&counters, counter, head) != head);
+#else
+    } while (!__atomic_compare_exchange_n(
+        &counters, &head, counter, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#endif
+
+    thread_counter = counter;
+
+    return counter;
+}
+
+/* Only the owning thread writes to its counter, so a relaxed store of the
+ * incremented value is enough to make the update visible to the collector. */
+static
+void count_alloc(
+    size_t size)
+{
+    if (!flag_get(&tracking_enabled)) {
+        return;
+    }
+
+    admin_alloc_counter_t *counter = thread_counter;
+    if (!counter) {
+        counter = counter_register();
+        if (!counter) {
+            return;
+        }
+    }
+
+    counter_store(&counter->alloc_count, counter->alloc_count + 1);
+    counter_store(&counter->alloc_bytes, counter->alloc_bytes + size);
+}
+
+static
+void count_free(void)
+{
+    if (!flag_get(&tracking_enabled)) {
+        return;
+    }
+
+    admin_alloc_counter_t *counter = thread_counter;
+    if (!counter) {
+        counter = counter_register();
+        if (!counter) {
+            return;
+        }
+    }
+
+    counter_store(&counter->free_count, counter->free_count + 1);
+}
+
+static
+void* track_malloc(
+    size_t size)
+{
+    count_alloc(size);
+    return prev_malloc(size);
+}
+
+static
+void* track_calloc(
+    size_t num,
+    size_t size)
+{
+    count_alloc(num * size);
+    return prev_calloc(num, size);
+}
+
+/* Only the growth of a block is counted. The size of the existing block is
+ * taken from the C library, as the OS API does not store it. The size is only
+ * requested while tracking is enabled, which requires that the OS API
+ * allocates from the C library. */
+static
+void* track_realloc(
+    void *ptr,
+    size_t size)
+{
+    if (!flag_get(&tracking_enabled)) {
+        return prev_realloc(ptr, size);
+    }
+
+    size_t prev_size = ptr ? admin_alloc_size(ptr) : 0;
+    void *result = prev_realloc(ptr, size);
+
+    if (result && size > prev_size) {
+        count_alloc(size - prev_size);
+    }
+
+    return result;
+}
+
+static
+void track_free(
+    void *ptr)
+{
+    if (ptr) {
+        count_free();
+    }
+    prev_free(ptr);
+}
+
+static
+void hooks_lock_acquire(void)
+{
+    while (!flag_set(&hooks_lock)) { }
+}
+
+static
+void hooks_lock_release(void)
+{
+    flag_clear(&hooks_lock);
+}
+
+/* The hooks forward to the original functions, so memory is freed correctly
+ * regardless of whether it was allocated before, while or after the hooks were
+ * installed. Sizes of freed blocks are not known, so only the number of frees
+ * is counted. */
+void admin_alloc_enable(void)
+{
+    hooks_lock_acquire();
+
+    if (!tracking_count ++) {
+        prev_malloc = ecs_os_api.malloc;
+        prev_realloc = ecs_os_api.realloc;
+        prev_calloc = ecs_os_api.calloc;
+        prev_free = ecs_os_api.free;
+
+        ecs_os_api.malloc = track_malloc;
+        ecs_os_api.realloc = track_realloc;
+        ecs_os_api.calloc = track_calloc;
+        ecs_os_api.free = track_free;
+
+        flag_set(&tracking_enabled);
+        ecs_os_dbg("admin: allocation tracking enabled");
+    }
+
+    hooks_lock_release();
+}
+
+/* Threads that are inside a hook while the hooks are removed still call the
+ * original functions, which is why prev_* are never reset. */
+void admin_alloc_disable(void)
+{
+    hooks_lock_acquire();
+
+    if (tracking_count && !-- tracking_count) {
+        flag_clear(&tracking_enabled);
+
+        ecs_os_api.malloc = prev_malloc;
+        ecs_os_api.realloc = prev_realloc;
+        ecs_os_api.calloc = prev_calloc;
+        ecs_os_api.free = prev_free;
+
+        ecs_os_dbg("admin: allocation tracking disabled");
+    }
+
+    hooks_lock_release();
+}
+
+bool admin_alloc_enabled(void)
+{
+    return flag_get(&tracking_enabled);
+}
+
+void admin_alloc_get(
+    admin_alloc_totals_t *totals_out)
+{
+    admin_alloc_totals_t totals = {0};
+
+    admin_alloc_counter_t *counter = counters;
+    while (counter) {
+        totals.alloc_count += counter_load(&counter->alloc_count);
+        totals.alloc_bytes += counter_load(&counter->alloc_bytes);
+        totals.free_count += counter_load(&counter->free_count);
+        counter = counter->next;
+    }
+
+    *totals_out = totals;
+}
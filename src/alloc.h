@@ -0,0 +1,30 @@
+#include <flecs_systems_admin.h>
+
+/* Allocation tracking wraps the allocation functions of the OS API, and counts
+ * allocations in per-thread counters. Counters are only written by the thread
+ * that owns them, so allocating does not require locking. */
+
+/* Totals of all threads since tracking was enabled */
+typedef struct admin_alloc_totals_t {
+    uint64_t alloc_count;
+    uint64_t alloc_bytes;
+    uint64_t free_count;
+} admin_alloc_totals_t;
+
+/* Enable tracking, which installs the allocation hooks if no other world
+ * tracks allocations. Tracking is process-wide, as the OS API is shared by all
+ * worlds. Tracking assumes that the OS API allocates from the C library, which
+ * is the default, as the size of a block is needed to count the growth of a
+ * realloc. */
+void admin_alloc_enable(void);
+
+/* Disable tracking for one world that enabled it. When no world tracks
+ * allocations, the original allocation functions are restored. */
+void admin_alloc_disable(void);
+
+/* Returns true if tracking is enabled */
+bool admin_alloc_enabled(void);
+
+/* Sum counters of all threads */
+void admin_alloc_get(
+    admin_alloc_totals_t *totals_out);
@@ -1,35 +1,238 @@
 #include <flecs_systems_admin.h>
 #include "collect.h"
+#include "alloc.h"
+#include "util.h"
+#include <math.h>
 
 #define MEASUREMENT_COUNT (60)
 
+/* Weight of a new sample in the exponentially weighted moving average. With a
+ * weight of 0.2, the contribution of a sample halves in about 3 samples. */
+#define EWMA_ALPHA (0.2)
+
+/* Encoding of the history of a metric. In compact mode counters, which change
+ * slowly compared to their value, are delta encoded. Other metrics (times,
+ * percentages and rates) are stored as float. */
 static
-const ecs_vector_params_t double_params = {
-    .element_size = sizeof(double)
-};
+admin_encoding_t admin_encoding(
+    bool compact,
+    bool counter)
+{
+    if (!compact) {
+        return AdminEncodingDouble;
+    } else if (counter) {
+        return AdminEncodingDelta;
+    } else {
+        return AdminEncodingFloat;
+    }
+}
 
+/* Standard deviations are not counters, so they are never delta encoded */
 static
-ecs_ringbuf_t* init_ringbuf(void)
+admin_encoding_t admin_stddev_encoding(
+    admin_encoding_t encoding)
 {
-    return ecs_ringbuf_new(&double_params, MEASUREMENT_COUNT);
+    if (encoding == AdminEncodingDouble) {
+        return AdminEncodingDouble;
+    } else {
+        return AdminEncodingFloat;
+    }
 }
 
 static
 void admin_stat_init(
+    admin_stat_t *stat,
+    admin_encoding_t encoding)
+{
+    admin_encoding_t stddev_encoding = admin_stddev_encoding(encoding);
+    stat->data_1m = admin_series_new(encoding, MEASUREMENT_COUNT);
+    stat->data_1h = admin_series_new(encoding, MEASUREMENT_COUNT);
+    stat->min_1h = admin_series_new(encoding, MEASUREMENT_COUNT);
+    stat->max_1h = admin_series_new(encoding, MEASUREMENT_COUNT);
+    stat->ewma_1m = admin_series_new(encoding, MEASUREMENT_COUNT);
+    stat->stddev_1m = admin_series_new(stddev_encoding, MEASUREMENT_COUNT);
+    stat->stddev_1h = admin_series_new(stddev_encoding, MEASUREMENT_COUNT);
+}
+
+/* Number of bytes used by the history of an admin_stat_t */
+static
+uint64_t admin_stat_bytes(
     admin_stat_t *stat)
 {
-    stat->data_1m = init_ringbuf();
-    stat->data_1h = init_ringbuf();
-    stat->min_1h = init_ringbuf();
-    stat->max_1h = init_ringbuf();
+    return admin_series_bytes(stat->data_1m) +
+        admin_series_bytes(stat->data_1h) +
+        admin_series_bytes(stat->min_1h) +
+        admin_series_bytes(stat->max_1h) +
+        admin_series_bytes(stat->ewma_1m) +
+        admin_series_bytes(stat->stddev_1m) +
+        admin_series_bytes(stat->stddev_1h);
+}
+
+/* Size that the history of an admin_stat_t would have, used to report memory
+ * that is saved by not allocating history */
+static
+uint64_t admin_stat_size(
+    admin_encoding_t encoding)
+{
+    size_t elem_size = encoding == AdminEncodingDouble 
+        ? sizeof(double) 
+        : sizeof(float)
+        ;
+
+    size_t stddev_size = admin_stddev_encoding(encoding) == AdminEncodingDouble
+        ? sizeof(double) 
+        : sizeof(float)
+        ;
+
+    return MEASUREMENT_COUNT * (5 * elem_size + 2 * stddev_size);
 }
 
 static
 void admin_memory_stat_init(
-    admin_memory_stat_t *stat)
+    admin_memory_stat_t *stat,
+    bool compact)
+{
+    admin_stat_init(&stat->used, admin_encoding(compact, true));
+    admin_stat_init(&stat->allocd, admin_encoding(compact, true));
+}
+
+static
+void admin_phase_stat_init(
+    admin_phase_stat_t *stat,
+    bool compact)
+{
+    admin_stat_init(&stat->time_spent_pct, admin_encoding(compact, false));
+    admin_stat_init(&stat->invoke_count, admin_encoding(compact, false));
+    admin_stat_init(&stat->active_systems, admin_encoding(compact, false));
+}
+
+/* Per-phase totals, accumulated while collecting system statistics */
+typedef struct admin_phase_accum_t {
+    double time_spent[ADMIN_PHASE_COUNT];
+    uint32_t invoke_count[ADMIN_PHASE_COUNT];
+    uint32_t active_systems[ADMIN_PHASE_COUNT];
+} admin_phase_accum_t;
+
+/* Totals accumulated while collecting statistics */
+typedef struct admin_collect_accum_t {
+    bool compact;               /* Store history in compact encoding */
+    admin_phase_accum_t phases;
+    double component_churn;     /* Component adds and removes since last sample */
+    double tables_matched;      /* Tables matched to systems since last sample */
+    uint32_t history_count;
+    uint32_t history_deferred_count;
+    uint64_t history_bytes;
+    uint64_t history_bytes_saved;
+} admin_collect_accum_t;
+
+/* Systems and components only get history once it is useful, which is when
+ * they have a non-trivial sample, or when a client requests it. Until then only
+ * the current value is tracked. This saves memory on worlds with many hidden
+ * or inactive systems and components. Returns true if history was allocated. */
+static
+bool admin_history_alloc(
+    admin_collect_accum_t *accum,
+    admin_stat_t **stats,
+    admin_encoding_t *encodings,
+    uint32_t stat_count,
+    bool has_history,
+    bool alloc)
+{
+    uint32_t i;
+
+    if (!has_history && alloc) {
+        for (i = 0; i < stat_count; i ++) {
+            admin_stat_init(stats[i], encodings[i]);
+        }
+        has_history = true;
+    }
+
+    if (has_history) {
+        accum->history_count ++;
+        for (i = 0; i < stat_count; i ++) {
+            accum->history_bytes += admin_stat_bytes(stats[i]);
+        }
+    } else {
+        accum->history_deferred_count ++;
+        for (i = 0; i < stat_count; i ++) {
+            accum->history_bytes_saved += admin_stat_size(encodings[i]);
+        }
+    }
+
+    return has_history;
+}
+
+/* Get index of phase in AdminWorldStats::phases. Returns -1 for reactive
+ * systems, as they do not run as part of a phase. */
+static
+int32_t admin_phase_index(
+    EcsSystemKind kind)
+{
+    switch(kind) {
+    case EcsOnLoad: return 0;
+    case EcsPostLoad: return 1;
+    case EcsPreUpdate: return 2;
+    case EcsOnUpdate: return 3;
+    case EcsOnValidate: return 4;
+    case EcsPostUpdate: return 5;
+    case EcsPreStore: return 6;
+    case EcsOnStore: return 7;
+    case EcsManual: return 8;
+    default: return -1;
+    }
+}
+
+static
+void welford_add(
+    admin_welford_t *w,
+    double value)
 {
-    admin_stat_init(&stat->used);
-    admin_stat_init(&stat->allocd);
+    w->count ++;
+    double delta = value - w->mean;
+    w->mean += delta / w->count;
+    w->m2 += delta * (value - w->mean);
+}
+
+/* Replace the oldest value in a window of fixed size with a new value */
+static
+void welford_replace(
+    admin_welford_t *w,
+    double old_value,
+    double value)
+{
+    double old_mean = w->mean;
+    w->mean += (value - old_value) / w->count;
+    w->m2 += (value - old_value) * (value - w->mean + old_value - old_mean);
+    if (w->m2 < 0) {
+        w->m2 = 0;
+    }
+}
+
+/* Sample standard deviation */
+static
+double welford_stddev(
+    admin_welford_t *w)
+{
+    if (w->count < 2) {
+        return 0;
+    }
+
+    return sqrt(w->m2 / (w->count - 1));
+}
+
+/* Recompute window from the samples in the ringbuffer. Replacing values in a
+ * window accumulates rounding errors, so the window is periodically rebuilt. */
+static
+void welford_rebuild(
+    admin_welford_t *w,
+    admin_series_t *series)
+{
+    admin_series_iter_t it = admin_series_iter(series);
+
+    *w = (admin_welford_t){0};
+    while (admin_series_next(&it)) {
+        welford_add(w, it.value);
+    }
 }
 
 /* Utility to push a new measurement to a ringbuffer that loops every hour */
@@ -38,12 +241,11 @@ void admin_stat_push(
     admin_stat_t *stat,
     double current)
 {
-    double *value = ecs_ringbuf_push(stat->data_1h, &double_params);
-    double *max = ecs_ringbuf_push(stat->max_1h, &double_params);
-    double *min = ecs_ringbuf_push(stat->min_1h, &double_params);
-    *value = 0;
-    *max = current;
-    *min = current;
+    admin_series_push(stat->data_1h, 0);
+    admin_series_push(stat->max_1h, current);
+    admin_series_push(stat->min_1h, current);
+    admin_series_push(stat->stddev_1h, 0);
+    stat->minute = (admin_welford_t){0};
 }
 
 /* Utility to add a measurement to a ringbuffer that loops every hour */
@@ -52,10 +254,27 @@ void admin_stat_add(
     admin_stat_t *stat,
     double current)
 {
-    uint32_t index = ecs_ringbuf_index(stat->data_1m);
+    if (!stat->data_1m) {
+        stat->current = current;
+        return;
+    }
+
+    uint32_t index = admin_series_index(stat->data_1m);
+    uint32_t count = admin_series_count(stat->data_1m);
+
+    /* The oldest sample is overwritten when the ringbuffer is full */
+    double oldest = 0;
+    if (count == MEASUREMENT_COUNT) {
+        oldest = admin_series_first(stat->data_1m);
+    }
 
-    double *elem = ecs_ringbuf_push(stat->data_1m, &double_params);
-    *elem = current;
+    admin_series_push(stat->data_1m, current);
+
+    if (count) {
+        stat->ewma += EWMA_ALPHA * (current - stat->ewma);
+    } else {
+        stat->ewma = current;
+    }
 
     stat->current = current;
 
@@ -63,12 +282,118 @@ void admin_stat_add(
         admin_stat_push(stat, current);
     }
 
-    double *value = ecs_ringbuf_last(stat->data_1h, &double_params);
-    double *max = ecs_ringbuf_last(stat->max_1h, &double_params);
-    double *min = ecs_ringbuf_last(stat->min_1h, &double_params);
-    *value = (*value * index + current) / (index + 1);
-    if (current > *max) *max = current;
-    if (current < *min) *min = current;
+    if (count == MEASUREMENT_COUNT) {
+        if (!(index % MEASUREMENT_COUNT)) {
+            welford_rebuild(&stat->window, stat->data_1m);
+        } else {
+            welford_replace(&stat->window, oldest, current);
+        }
+    } else {
+        welford_add(&stat->window, current);
+    }
+
+    welford_add(&stat->minute, current);
+
+    stat->stddev = welford_stddev(&stat->window);
+
+    admin_series_push(stat->ewma_1m, stat->ewma);
+    admin_series_push(stat->stddev_1m, stat->stddev);
+    admin_series_set_last(stat->stddev_1h, welford_stddev(&stat->minute));
+
+    double value = admin_series_last(stat->data_1h);
+    admin_series_set_last(stat->data_1h, (value * index + current) / (index + 1));
+
+    if (current > admin_series_last(stat->max_1h)) {
+        admin_series_set_last(stat->max_1h, current);
+    }
+    if (current < admin_series_last(stat->min_1h)) {
+        admin_series_set_last(stat->min_1h, current);
+    }
+}
+
+/* Half-life of samples in the long term regression, in minutes */
+#define TREND_HALF_LIFE (360)
+
+/* Minimum number of minutes before growth is reported */
+#define TREND_MIN_SAMPLES (10)
+
+/* Minimum r2 before growth counts as sustained */
+#define TREND_MIN_R2 (0.75)
+
+/* Compute trend from (weighted) regression sums. Samples are one minute apart,
+ * so the slope is converted to change per second. */
+static
+void admin_trend_compute(
+    admin_trend_t *trend,
+    uint32_t count,
+    double w, double sx, double sy, double sxx, double sxy, double syy)
+{
+    double var_x = w * sxx - sx * sx;
+    double var_y = w * syy - sy * sy;
+    double cov = w * sxy - sx * sy;
+
+    if (count < TREND_MIN_SAMPLES || var_x <= 0) {
+        *trend = (admin_trend_t){0};
+        return;
+    }
+
+    double slope = cov / var_x;
+    double r2 = var_y > 0 ? (cov * cov) / (var_x * var_y) : 0;
+
+    trend->slope = slope / 60;
+    trend->r2 = r2;
+    trend->growing = slope > 0 && r2 >= TREND_MIN_R2;
+}
+
+/* Compute the regression over the last hour from the per-minute averages. This
+ * runs once per minute, and costs at most MEASUREMENT_COUNT iterations. */
+static
+void admin_trend_1h(
+    admin_trend_t *trend,
+    admin_stat_t *stat)
+{
+    double w = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    admin_series_iter_t it = admin_series_iter(stat->data_1h);
+
+    while (admin_series_next(&it)) {
+        double x = it.index - 1;
+        double y = it.value;
+        w ++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        syy += y * y;
+    }
+
+    admin_trend_compute(trend, (uint32_t)w, w, sx, sy, sxx, sxy, syy);
+}
+
+/* Add a per-minute average to the long term regression */
+static
+void admin_trend_long(
+    admin_trend_t *trend,
+    admin_regression_t *r,
+    double y)
+{
+    double decay = pow(0.5, 1.0 / TREND_HALF_LIFE);
+
+    /* Move existing samples one minute back (x - 1), so the new sample can be
+     * added at x = 0. The slope does not depend on where x starts. */
+    r->sxx = r->sxx - 2 * r->sx + r->w;
+    r->sxy = r->sxy - r->sy;
+    r->sx = r->sx - r->w;
+
+    r->w = r->w * decay + 1;
+    r->sx = r->sx * decay;
+    r->sy = r->sy * decay + y;
+    r->sxx = r->sxx * decay;
+    r->sxy = r->sxy * decay;
+    r->syy = r->syy * decay + y * y;
+    r->count ++;
+
+    admin_trend_compute(trend, r->count, 
+        r->w, r->sx, r->sy, r->sxx, r->sxy, r->syy);
 }
 
 /* Utility to add a memory measurement to ringbuffer that loops every hour */
@@ -77,6 +402,19 @@ void admin_memory_stat_add(
     admin_memory_stat_t *stat,
     ecs_memory_stat_t *value)
 {
+    /* When a minute completes, update the trends with the average of the
+     * minute before it is replaced by the next one */
+    uint32_t index = stat->used.data_1m 
+        ? admin_series_index(stat->used.data_1m) 
+        : 0
+        ;
+
+    if (index && !(index % MEASUREMENT_COUNT)) {
+        double last = admin_series_last(stat->used.data_1h);
+        admin_trend_1h(&stat->trend_1h, &stat->used);
+        admin_trend_long(&stat->trend_long, &stat->regression, last);
+    }
+
     admin_stat_add(&stat->used, value->used_bytes);
     admin_stat_add(&stat->allocd, value->allocd_bytes);
 }
@@ -84,16 +422,16 @@ void admin_memory_stat_add(
 static
 void AdminAddWorldStats(ecs_rows_t *rows) 
 {
+    ECS_COLUMN(rows, EcsWorldStats, stats, 1);
     ECS_COLUMN_COMPONENT(rows, AdminWorldStats, 2);
-    ecs_set(rows->world, rows->entities[0], AdminWorldStats, {0});
-
-    AdminWorldStats *stat = ecs_get_ptr(
-        rows->world, rows->entities[0], AdminWorldStats);
 
-    admin_stat_init(&stat->fps);
-    admin_stat_init(&stat->frame);
-    admin_stat_init(&stat->system);
-    admin_stat_init(&stat->merge);
+    /* History is allocated by AdminCollectWorldStats, which knows whether the
+     * history should be stored in compact encoding */
+    ecs_set(rows->world, rows->entities[0], AdminWorldStats, {
+        .prev_entity_count = stats->entities_count,
+        .prev_table_count = stats->tables_count,
+        .prev_col_systems_count = stats->col_systems_count
+    });
 }
 
 static
@@ -101,51 +439,70 @@ void AdminAddMemoryStats(ecs_rows_t *rows)
 {
     ECS_COLUMN_COMPONENT(rows, AdminMemoryStats, 2);
 
+    /* History is allocated by AdminCollectMemoryStats */
     ecs_set(rows->world, rows->entities[0], AdminMemoryStats, {{{0}}});
-
-    AdminMemoryStats *stat = ecs_get_ptr(
-        rows->world, rows->entities[0], AdminMemoryStats);
-
-    admin_memory_stat_init(&stat->total);
-    admin_memory_stat_init(&stat->entities);
-    admin_memory_stat_init(&stat->components);
-    admin_memory_stat_init(&stat->systems);
-    admin_memory_stat_init(&stat->types);
-    admin_memory_stat_init(&stat->stages);
-    admin_memory_stat_init(&stat->tables);
-    admin_memory_stat_init(&stat->world);
 }
 
 static
 void AdminAddSystemStats(ecs_rows_t *rows) 
 {
+    ECS_COLUMN(rows, EcsSystemStats, stats, 1);
     ECS_COLUMN_COMPONENT(rows, AdminSystemStats, 2);
 
+    /* History is allocated by AdminCollectSystemStats */
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
-        ecs_set(rows->world, rows->entities[i], AdminSystemStats, {0});
+        ecs_set(rows->world, rows->entities[i], AdminSystemStats, {
+            .prev_is_active = stats[i].is_active,
+            .prev_tables_matched = stats[i].tables_matched_count
+        });
+    }
+}
 
-        AdminSystemStats *stat = ecs_get_ptr(
-            rows->world, rows->entities[i], AdminSystemStats);        
+/* Count transitions between active and inactive. Runs every frame, unlike the
+ * collection systems, so that transitions between samples are not missed. */
+static
+void AdminTrackSystemActivation(ecs_rows_t *rows) 
+{
+    ECS_COLUMN(rows, EcsSystemStats, stats, 1);
+    ECS_COLUMN(rows, AdminSystemStats, admin_stats, 2);
 
-        admin_stat_init(&stat->time_spent);
-        admin_stat_init(&stat->time_spent_pct);
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        if (stats[i].is_active != admin_stats[i].prev_is_active) {
+            admin_stats[i].activations_total ++;
+            admin_stats[i].prev_is_active = stats[i].is_active;
+        }
     }
 }
 
 static
 void AdminAddComponentStats(ecs_rows_t *rows) 
 {
+    ECS_COLUMN(rows, EcsComponentStats, stats, 1);
     ECS_COLUMN_COMPONENT(rows, AdminComponentStats, 2);
 
+    /* History is allocated by AdminCollectComponentStats */
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
-        ecs_set(rows->world, rows->entities[i], AdminComponentStats, {{{0}}});
+        ecs_set(rows->world, rows->entities[i], AdminComponentStats, {
+            .prev_entity_count = stats[i].entities_count
+        });
+    }
+}
 
-        AdminComponentStats *stat = ecs_get_ptr(
-            rows->world, rows->entities[i], AdminComponentStats);        
+static
+void AdminAddMetricStats(ecs_rows_t *rows) 
+{
+    ECS_COLUMN(rows, EcsAdminMetric, metric, 1);
+    ECS_COLUMN_COMPONENT(rows, AdminMetricStats, 2);
 
-        admin_memory_stat_init(&stat->memory);
+    /* History is allocated by AdminCollectMetricStats */
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_set(rows->world, rows->entities[i], AdminMetricStats, {
+            .prev_value = ecs_admin_metric_get(metric[i].metric, metric[i].kind)
+        });
     }
 }
 
@@ -155,6 +512,33 @@ void AdminCollectWorldStats(ecs_rows_t *rows)
     ECS_COLUMN(rows, EcsWorldStats, stats, 1);
     ECS_COLUMN(rows, AdminWorldStats, admin_stats, 2);
 
+    admin_collect_accum_t *accum = rows->param;
+
+    if (!admin_stats->fps.data_1m) {
+        admin_encoding_t encoding = admin_encoding(accum->compact, false);
+        admin_stat_init(&admin_stats->fps, encoding);
+        admin_stat_init(&admin_stats->frame, encoding);
+        admin_stat_init(&admin_stats->system, encoding);
+        admin_stat_init(&admin_stats->merge, encoding);
+        admin_stat_init(&admin_stats->entity_rate, encoding);
+        admin_stat_init(&admin_stats->table_rate, encoding);
+        admin_stat_init(&admin_stats->component_churn, encoding);
+        admin_stat_init(&admin_stats->table_match_rate, encoding);
+        admin_stat_init(&admin_stats->table_match_tests, encoding);
+        admin_stat_init(&admin_stats->frame_overhead, encoding);
+        admin_stat_init(&admin_stats->alloc_rate, encoding);
+        admin_stat_init(&admin_stats->alloc_bytes_rate, encoding);
+        admin_stat_init(&admin_stats->free_rate, encoding);
+
+        uint32_t i;
+        for (i = 0; i < ADMIN_PHASE_COUNT; i ++) {
+            admin_phase_stat_init(&admin_stats->phases[i], accum->compact);
+        }
+
+        admin_stats->collect_times = admin_series_new(
+            AdminEncodingDouble, ADMIN_COLLECT_TIMES);
+    }
+
     double delta_time = rows->delta_time;
     double frame_time_cur = stats->frame_seconds_total - admin_stats->prev_frame_time;
     double system_time_cur = stats->system_seconds_total - admin_stats->prev_system_time;
@@ -175,10 +559,67 @@ void AdminCollectWorldStats(ecs_rows_t *rows)
     admin_stat_add(&admin_stats->system, system_time);
     admin_stat_add(&admin_stats->merge, merge_time);
 
+    /* Time spent in a frame outside of systems and merges, which includes
+     * creating tables and matching them with systems */
+    double frame_overhead = frame_time - system_time - merge_time;
+    admin_stat_add(&admin_stats->frame_overhead, 
+        frame_overhead > 0 ? frame_overhead : 0);
+
+    /* Each new table is tested against all systems, and each new system
+     * against all tables */
+    double new_tables = (double)stats->tables_count - 
+        admin_stats->prev_table_count;
+    double new_systems = (double)stats->col_systems_count - 
+        admin_stats->prev_col_systems_count;
+    double match_tests = 
+        (new_tables > 0 ? new_tables * stats->col_systems_count : 0) +
+        (new_systems > 0 ? new_systems * stats->tables_count : 0);
+
+    double entity_rate = 0, table_rate = 0, component_churn = 0;
+    double table_match_tests = 0;
+    if (delta_time) {
+        entity_rate = ((double)stats->entities_count - 
+            admin_stats->prev_entity_count) / delta_time;
+        table_rate = new_tables / delta_time;
+        component_churn = accum->component_churn / delta_time;
+        table_match_tests = match_tests / delta_time;
+    }
+
+    admin_stat_add(&admin_stats->entity_rate, entity_rate);
+    admin_stat_add(&admin_stats->table_rate, table_rate);
+    admin_stat_add(&admin_stats->component_churn, component_churn);
+    admin_stat_add(&admin_stats->table_match_tests, table_match_tests);
+
+    if (admin_alloc_enabled()) {
+        admin_alloc_totals_t allocs;
+        admin_alloc_get(&allocs);
+
+        if (delta_time) {
+            admin_stat_add(&admin_stats->alloc_rate, 
+                (allocs.alloc_count - admin_stats->prev_alloc_count) / delta_time);
+            admin_stat_add(&admin_stats->alloc_bytes_rate, 
+                (allocs.alloc_bytes - admin_stats->prev_alloc_bytes) / delta_time);
+            admin_stat_add(&admin_stats->free_rate, 
+                (allocs.free_count - admin_stats->prev_free_count) / delta_time);
+        }
+
+        admin_stats->prev_alloc_count = allocs.alloc_count;
+        admin_stats->prev_alloc_bytes = allocs.alloc_bytes;
+        admin_stats->prev_free_count = allocs.free_count;
+    }
+
+    admin_stats->prev_entity_count = stats->entities_count;
+    admin_stats->prev_table_count = stats->tables_count;
+    admin_stats->prev_col_systems_count = stats->col_systems_count;
     admin_stats->prev_frame_time = stats->frame_seconds_total;
     admin_stats->prev_system_time = stats->system_seconds_total;
     admin_stats->prev_merge_time = stats->merge_seconds_total;
     admin_stats->prev_tick = stats->frame_count_total;
+
+    /* Samples of all statistics are taken at the same time, which is used to
+     * timestamp exported history */
+    admin_stats->collect_time = admin_unix_time();
+    admin_series_push(admin_stats->collect_times, admin_stats->collect_time);
 }
 
 static
@@ -187,6 +628,19 @@ void AdminCollectMemoryStats(ecs_rows_t *rows)
     ECS_COLUMN(rows, EcsMemoryStats, stats, 1);
     ECS_COLUMN(rows, AdminMemoryStats, admin_stats, 2);
 
+    admin_collect_accum_t *accum = rows->param;
+
+    if (!admin_stats->total.used.data_1m) {
+        admin_memory_stat_init(&admin_stats->total, accum->compact);
+        admin_memory_stat_init(&admin_stats->entities, accum->compact);
+        admin_memory_stat_init(&admin_stats->components, accum->compact);
+        admin_memory_stat_init(&admin_stats->systems, accum->compact);
+        admin_memory_stat_init(&admin_stats->types, accum->compact);
+        admin_memory_stat_init(&admin_stats->stages, accum->compact);
+        admin_memory_stat_init(&admin_stats->tables, accum->compact);
+        admin_memory_stat_init(&admin_stats->world, accum->compact);
+    }
+
     admin_memory_stat_add(&admin_stats->total, &stats->total_memory);
     admin_memory_stat_add(&admin_stats->entities, &stats->entities_memory);
     admin_memory_stat_add(&admin_stats->components, &stats->components_memory);
@@ -203,30 +657,163 @@ void AdminCollectSystemStats(ecs_rows_t *rows)
     ECS_COLUMN(rows, EcsSystemStats, stats, 1);
     ECS_COLUMN(rows, AdminSystemStats, admin_stats, 2);
 
+    admin_collect_accum_t *accum = rows->param;
+    admin_phase_accum_t *phases = &accum->phases;
+
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
         admin_stats[i].invoke_count = stats[i].invoke_count_total - admin_stats[i].prev_invoke_count_total;
+
+        /* Hidden systems only get history when requested, other systems when
+         * they are first invoked */
+        admin_encoding_t encoding = admin_encoding(accum->compact, false);
+        admin_encoding_t counter = admin_encoding(accum->compact, true);
+        admin_history_alloc(accum, (admin_stat_t*[]){
+                &admin_stats[i].time_spent, 
+                &admin_stats[i].time_spent_pct,
+                &admin_stats[i].tables_matched,
+                &admin_stats[i].entities_matched,
+                &admin_stats[i].activation_rate
+            }, (admin_encoding_t[]){
+                encoding, encoding, counter, counter, encoding},
+            5, admin_stats[i].time_spent.data_1m != NULL,
+            admin_flag_get(&admin_stats[i].history_requested) || 
+                (!stats[i].is_hidden && admin_stats[i].invoke_count));
         
         double time_spent = stats[i].seconds_total - admin_stats[i].prev_seconds_total;
         double time_spent_pct = (time_spent / rows->delta_time) * 100;
         admin_stat_add(&admin_stats[i].time_spent, time_spent);
         admin_stat_add(&admin_stats[i].time_spent_pct, time_spent_pct);
 
+        admin_stat_add(&admin_stats[i].tables_matched, 
+            stats[i].tables_matched_count);
+        admin_stat_add(&admin_stats[i].entities_matched, 
+            stats[i].entities_matched_count);
+
+        double activations = admin_stats[i].activations_total - 
+            admin_stats[i].prev_activations_total;
+        admin_stat_add(&admin_stats[i].activation_rate, rows->delta_time
+            ? activations / rows->delta_time
+            : 0);
+
+        /* Only count increases, so that tables that are no longer matched do
+         * not cancel out the matching work of new tables */
+        if (stats[i].tables_matched_count > admin_stats[i].prev_tables_matched) {
+            accum->tables_matched += stats[i].tables_matched_count - 
+                admin_stats[i].prev_tables_matched;
+        }
+
+        int32_t phase = admin_phase_index(stats[i].kind);
+        if (phase != -1) {
+            phases->time_spent[phase] += time_spent;
+            phases->invoke_count[phase] += admin_stats[i].invoke_count;
+            if (stats[i].is_enabled && stats[i].is_active) {
+                phases->active_systems[phase] ++;
+            }
+        }
+
         admin_stats[i].prev_seconds_total = stats[i].seconds_total;
         admin_stats[i].prev_invoke_count_total = stats[i].invoke_count_total;
+        admin_stats[i].prev_tables_matched = stats[i].tables_matched_count;
+        admin_stats[i].prev_activations_total = admin_stats[i].activations_total;
     }
 }
 
+/* Add per-phase totals accumulated by AdminCollectSystemStats */
+static
+void AdminCollectPhaseStats(ecs_rows_t *rows) 
+{
+    ECS_COLUMN(rows, AdminWorldStats, admin_stats, 1);
+
+    admin_collect_accum_t *accum = rows->param;
+    admin_phase_accum_t *phases = &accum->phases;
+
+    uint32_t i;
+    for (i = 0; i < ADMIN_PHASE_COUNT; i ++) {
+        admin_phase_stat_t *stat = &admin_stats->phases[i];
+        double time_spent_pct = (phases->time_spent[i] / rows->delta_time) * 100;
+
+        admin_stat_add(&stat->time_spent_pct, time_spent_pct);
+        admin_stat_add(&stat->invoke_count, phases->invoke_count[i]);
+        admin_stat_add(&stat->active_systems, phases->active_systems[i]);
+    }
+
+    admin_stat_add(&admin_stats->table_match_rate, rows->delta_time
+        ? accum->tables_matched / rows->delta_time
+        : 0);
+
+    /* Systems and components have been collected at this point */
+    admin_stats->history_count = accum->history_count;
+    admin_stats->history_deferred_count = accum->history_deferred_count;
+    admin_stats->history_bytes = accum->history_bytes;
+    admin_stats->history_bytes_saved = accum->history_bytes_saved;
+}
+
 static
 void AdminCollectComponentStats(ecs_rows_t *rows) 
 {
     ECS_COLUMN(rows, EcsComponentStats, stats, 1);
     ECS_COLUMN(rows, AdminComponentStats, admin_stats, 2);
 
+    admin_collect_accum_t *accum = rows->param;
+
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
+        /* Components get history once they are added to an entity */
+        admin_encoding_t memory = admin_encoding(accum->compact, true);
+        admin_encoding_t rate = admin_encoding(accum->compact, false);
+        admin_history_alloc(accum, (admin_stat_t*[]){
+                &admin_stats[i].memory.used, 
+                &admin_stats[i].memory.allocd,
+                &admin_stats[i].entity_rate
+            }, (admin_encoding_t[]){memory, memory, rate},
+            3, admin_stats[i].entity_rate.data_1m != NULL,
+            admin_flag_get(&admin_stats[i].history_requested) || stats[i].entities_count);
+
         admin_memory_stat_add(&admin_stats[i].memory, &stats[i].memory);
-    }    
+
+        double delta = (double)stats[i].entities_count - 
+            admin_stats[i].prev_entity_count;
+
+        admin_stat_add(&admin_stats[i].entity_rate, rows->delta_time
+            ? delta / rows->delta_time
+            : 0);
+
+        accum->component_churn += delta < 0 ? -delta : delta;
+
+        admin_stats[i].prev_entity_count = stats[i].entities_count;
+    }
+}
+
+static
+void AdminCollectMetricStats(ecs_rows_t *rows) 
+{
+    ECS_COLUMN(rows, EcsAdminMetric, metric, 1);
+    ECS_COLUMN(rows, AdminMetricStats, admin_stats, 2);
+
+    admin_collect_accum_t *accum = rows->param;
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        if (!admin_stats[i].value.data_1m) {
+            admin_stat_init(&admin_stats[i].value, 
+                admin_encoding(accum->compact, false));
+        }
+
+        double value = ecs_admin_metric_get(metric[i].metric, metric[i].kind);
+
+        if (metric[i].kind == EcsAdminCounter) {
+            double rate = rows->delta_time
+                ? (value - admin_stats[i].prev_value) / rows->delta_time
+                : 0
+                ;
+
+            admin_stat_add(&admin_stats[i].value, rate);
+            admin_stats[i].prev_value = value;
+        } else {
+            admin_stat_add(&admin_stats[i].value, value);
+        }
+    }
 }
 
 static
@@ -235,14 +822,24 @@ void AdminCollectMetrics(ecs_rows_t *rows) {
     ECS_COLUMN_ENTITY(rows, AdminCollectMemoryStats, 2);
     ECS_COLUMN_ENTITY(rows, AdminCollectSystemStats, 3);
     ECS_COLUMN_ENTITY(rows, AdminCollectComponentStats, 4);
+    ECS_COLUMN_ENTITY(rows, AdminCollectMetricStats, 5);
+    ECS_COLUMN_ENTITY(rows, AdminCollectPhaseStats, 6);
+    ECS_COLUMN(rows, AdminCollectConfig, config, 7);
 
     ecs_world_t *world = rows->world;
     double delta_time = rows->delta_time;
-    
-    ecs_run(world, AdminCollectWorldStats, delta_time, NULL);
-    ecs_run(world, AdminCollectMemoryStats, delta_time, NULL);
-    ecs_run(world, AdminCollectSystemStats, delta_time, NULL);
-    ecs_run(world, AdminCollectComponentStats, delta_time, NULL);    
+    admin_collect_accum_t accum = {
+        .compact = config->compact_history
+    };
+
+    /* Component statistics are collected before world statistics, as the
+     * world statistics aggregate the component churn. */
+    ecs_run(world, AdminCollectComponentStats, delta_time, &accum);
+    ecs_run(world, AdminCollectWorldStats, delta_time, &accum);
+    ecs_run(world, AdminCollectMemoryStats, delta_time, &accum);
+    ecs_run(world, AdminCollectSystemStats, delta_time, &accum);
+    ecs_run(world, AdminCollectPhaseStats, delta_time, &accum);
+    ecs_run(world, AdminCollectMetricStats, delta_time, &accum);
 }
 
 void AdminCollectImport(
@@ -257,6 +854,8 @@ void AdminCollectImport(
     ECS_COMPONENT(world, AdminMemoryStats);
     ECS_COMPONENT(world, AdminSystemStats);
     ECS_COMPONENT(world, AdminComponentStats);
+    ECS_COMPONENT(world, AdminMetricStats);
+    ECS_COMPONENT(world, AdminCollectConfig);
 
     /* Add admin stats components to monitored entities */
     ECS_SYSTEM(world, AdminAddWorldStats, EcsPostLoad, 
@@ -271,10 +870,21 @@ void AdminCollectImport(
         EcsSystemStats, [out] !AdminSystemStats,
         SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
 
+    /* Track activation of systems every frame */
+    ECS_SYSTEM(world, AdminTrackSystemActivation, EcsPostLoad, 
+        [in] EcsSystemStats, [out] AdminSystemStats,
+        SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
+
     ECS_SYSTEM(world, AdminAddComponentStats, EcsPostLoad, 
         EcsComponentStats, [out] !AdminComponentStats,
         SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
 
+    /* EcsAdminMetric is registered by the FlecsSystemsAdmin module before it
+     * imports this module, so it can be used in system signatures. */
+    ECS_SYSTEM(world, AdminAddMetricStats, EcsPostLoad, 
+        EcsAdminMetric, [out] !AdminMetricStats,
+        SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
+
     /* Collect admin metrics */
     ECS_SYSTEM(world, AdminCollectWorldStats, EcsManual,
         [in] EcsWorldStats, [out] AdminWorldStats,
@@ -288,10 +898,20 @@ void AdminCollectImport(
         [in] EcsSystemStats, [out] AdminSystemStats,
         SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
 
+    /* Aggregate system statistics per phase. Runs after AdminCollectSystemStats,
+     * which accumulates the per-phase totals. */
+    ECS_SYSTEM(world, AdminCollectPhaseStats, EcsManual,
+        [out] AdminWorldStats,
+        SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
+
     ECS_SYSTEM(world, AdminCollectComponentStats, EcsManual,
         [in] EcsComponentStats, [out] AdminComponentStats,
         SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
 
+    ECS_SYSTEM(world, AdminCollectMetricStats, EcsManual,
+        [in] EcsAdminMetric, [out] AdminMetricStats,
+        SYSTEM.EcsOnDemand, SYSTEM.EcsHidden);
+
     /* Single system that runs manual collection systems. This way we only need
      * to set the period on this system to control at which period all of the
      * collection systems are ran. */
@@ -300,10 +920,13 @@ void AdminCollectImport(
         .AdminCollectMemoryStats,
         .AdminCollectSystemStats,
         .AdminCollectComponentStats,
+        .AdminCollectMetricStats,
+        .AdminCollectPhaseStats,
+        SYSTEM.AdminCollectConfig,
         SYSTEM.EcsHidden);
 
     /* Run admin metrics collection once per second */
-    ecs_set_period(world, AdminCollectMetrics, 1.0);
+    ecs_set_period(world, AdminCollectMetrics, ADMIN_COLLECT_PERIOD);
 
     /* Store all admin collection systems in a feature so they can be easily
      * enabled/disabled at once */
@@ -311,11 +934,15 @@ void AdminCollectImport(
         AdminAddWorldStats,
         AdminAddMemoryStats,
         AdminAddSystemStats,
+        AdminTrackSystemActivation,
         AdminAddComponentStats,
+        AdminAddMetricStats,
         AdminCollectWorldStats,
         AdminCollectMemoryStats,
         AdminCollectSystemStats,
-        AdminCollectComponentStats);
+        AdminCollectPhaseStats,
+        AdminCollectComponentStats,
+        AdminCollectMetricStats);
 
     /* Make this a hidden feature as it exposes internals of the module */
     ecs_add(world, AdminCollectSystems, EcsHidden);
@@ -323,5 +950,8 @@ void AdminCollectImport(
     ECS_EXPORT_COMPONENT(AdminWorldStats);    
     ECS_EXPORT_COMPONENT(AdminSystemStats);
     ECS_EXPORT_COMPONENT(AdminComponentStats);
+    ECS_EXPORT_COMPONENT(AdminMetricStats);
+    ECS_EXPORT_COMPONENT(AdminCollectConfig);
+    ECS_EXPORT_ENTITY(AdminCollectMetrics);
     ECS_EXPORT_ENTITY(AdminCollectSystems);
 }
\ No newline at end of file
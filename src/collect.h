@@ -1,36 +1,123 @@
 #include <flecs_systems_admin.h>
+#include "series.h"
 
 /* The AdminCollect module collects statistics from the FlecsStats module and
  * stores them in a way that is easy to use for the AdminHttp module. */
 
-/* Type that keeps track of a metric over 1m, 1h and tracks min & max */
+/* Running mean and sum of squared differences from the mean, updated with
+ * Welford's algorithm, which is numerically stable for long running series */
+typedef struct admin_welford_t {
+    uint32_t count;
+    double mean;
+    double m2;
+} admin_welford_t;
+
+/* Type that keeps track of a metric over 1m, 1h and tracks min & max. The
+ * ringbuffers of system and component stats are allocated lazily, until then
+ * only the current value is tracked and the ringbuffers are NULL. */
 typedef struct admin_stat_t {
     double current;
-    ecs_ringbuf_t *data_1m;
-    ecs_ringbuf_t *data_1h;
-    ecs_ringbuf_t *min_1h;
-    ecs_ringbuf_t *max_1h;
+    double ewma;                /* Exponentially weighted moving average */
+    double stddev;              /* Standard deviation of the last minute */
+    admin_series_t *data_1m;
+    admin_series_t *data_1h;
+    admin_series_t *min_1h;
+    admin_series_t *max_1h;
+    admin_series_t *ewma_1m;    /* EWMA per sample */
+    admin_series_t *stddev_1m;  /* Standard deviation of last minute per sample */
+    admin_series_t *stddev_1h;  /* Standard deviation per minute */
+    admin_welford_t window;     /* Samples in data_1m */
+    admin_welford_t minute;     /* Samples in current minute of data_1h */
 } admin_stat_t;
 
-/* For each memory metric both memory in use and memory allocated is tracked */
+/* Result of a linear regression of a metric over time */
+typedef struct admin_trend_t {
+    double slope;       /* Change of the metric per second */
+    double r2;          /* Coefficient of determination, 0 (noise) .. 1 */
+    bool growing;       /* True if the metric shows sustained growth */
+} admin_trend_t;
+
+/* Exponentially weighted sums of an online linear regression. Older samples
+ * are gradually forgotten, so the regression covers a window that is longer
+ * than what is stored in the ringbuffers. The x of the latest sample is always
+ * 0, so that the sums stay bounded. */
+typedef struct admin_regression_t {
+    double w, sx, sy, sxx, sxy, syy;
+    uint32_t count;     /* Number of samples added, not decayed */
+} admin_regression_t;
+
+/* For each memory metric both memory in use and memory allocated is tracked.
+ * Memory in use is analyzed for growth, to detect slow leaks. */
 typedef struct admin_memory_stat_t {
     admin_stat_t used;
     admin_stat_t allocd;
+    admin_trend_t trend_1h;
+    admin_trend_t trend_long;
+    admin_regression_t regression;
 } admin_memory_stat_t;
 
+/* Number of phases for which aggregate statistics are tracked. Phases are
+ * stored in pipeline order (on_load ... on_store), followed by manual. */
+#define ADMIN_PHASE_COUNT (9)
+
+/* Aggregated statistics of all systems in a phase */
+typedef struct admin_phase_stat_t {
+    admin_stat_t time_spent_pct;
+    admin_stat_t invoke_count;
+    admin_stat_t active_systems;
+} admin_phase_stat_t;
+
 /* Admin specific world stats */
 typedef struct AdminWorldStats {
     uint64_t tick;
+    double collect_time;            /* Unix time of the last collection */
+
+    /* Unix time of each collection of the last hour, newest last. Every
+     * statistic adds one sample per collection, so the time of a sample is
+     * found by its distance to the newest sample of its series. */
+    admin_series_t *collect_times;
     admin_stat_t fps;
     admin_stat_t frame;
     admin_stat_t system;
     admin_stat_t merge;
+    admin_phase_stat_t phases[ADMIN_PHASE_COUNT];
+
+    /* Churn rates, in changes per second. FlecsStats only provides counts, so
+     * rates are computed from the difference between samples. */
+    admin_stat_t entity_rate;       /* Net entities created per second */
+    admin_stat_t table_rate;        /* Tables created per second */
+    admin_stat_t component_churn;   /* Sum of component add/remove rates */
+
+    /* Cost of table matching. FlecsStats does not measure the time spent
+     * matching tables to systems, so it is approximated by the matching work
+     * and by the frame time that is not spent in systems or merges. */
+    admin_stat_t table_match_rate;  /* Tables matched to systems per second */
+    admin_stat_t table_match_tests; /* New tables tested against systems per second */
+    admin_stat_t frame_overhead;    /* Frame time outside systems and merges */
+
+    /* Allocation rates, only collected when allocation tracking is enabled */
+    admin_stat_t alloc_rate;        /* Allocations per second */
+    admin_stat_t alloc_bytes_rate;  /* Bytes allocated per second */
+    admin_stat_t free_rate;         /* Frees per second */
 
     /* Keep data from previous tick to compute diff with current */
     double prev_frame_time;
     double prev_system_time;
     double prev_merge_time;
     uint64_t prev_tick;
+    uint32_t prev_entity_count;
+    uint32_t prev_table_count;
+    uint32_t prev_col_systems_count;
+    uint64_t prev_alloc_count;
+    uint64_t prev_alloc_bytes;
+    uint64_t prev_free_count;
+
+    /* Number of systems and components with and without history, and memory
+     * saved by not allocating history for the latter */
+    uint32_t history_count;
+    uint32_t history_deferred_count;
+    uint64_t history_bytes;
+    uint64_t history_bytes_saved;
 } AdminWorldStats;
 
 /* Admin specific memory stats */
@@ -48,23 +135,66 @@ typedef struct AdminMemoryStats {
 /* Admin specific system stats */
 typedef struct AdminSystemStats {
     uint64_t invoke_count;
+    volatile int32_t history_requested; /* Set with admin_flag_set */
     admin_stat_t time_spent;
     admin_stat_t time_spent_pct;
+    admin_stat_t tables_matched;
+    admin_stat_t entities_matched;
+    admin_stat_t activation_rate;   /* Active/inactive transitions per second */
+
+    /* Activation transitions are counted every frame, as a system can become
+     * active and inactive again between two samples */
+    uint64_t activations_total;
+    bool prev_is_active;
 
     uint64_t prev_invoke_count_total;
     double prev_seconds_total;
+    uint32_t prev_tables_matched;
+    uint64_t prev_activations_total;
 } AdminSystemStats;
 
 /* Admin specific component stats */
 typedef struct AdminComponentStats {
     admin_memory_stat_t memory;
+    volatile int32_t history_requested; /* Set with admin_flag_set */
+
+    /* Net number of entities the component is added to per second */
+    admin_stat_t entity_rate;
+    uint32_t prev_entity_count;
 } AdminComponentStats;
 
+/* Admin specific stats for application-defined metrics */
+typedef struct AdminMetricStats {
+    admin_stat_t value;
+
+    /* Counter value of previous sample, to compute rate with current */
+    double prev_value;
+} AdminMetricStats;
+
+/* Configuration of the collection systems, stored on AdminCollectMetrics */
+typedef struct AdminCollectConfig {
+    /* Store history as float, and memory as float deltas. This halves the
+     * memory used by history, at the cost of precision. */
+    bool compact_history;
+} AdminCollectConfig;
+
+/* Default period at which statistics are collected, in seconds. The history of
+ * a metric is stored per sample, so with a different period the 1m and 1h
+ * series cover 60 samples and 60x60 samples respectively. */
+#define ADMIN_COLLECT_PERIOD (1.0)
+
+/* Number of collections of which the time is stored, which is the number of
+ * samples covered by the 1h series */
+#define ADMIN_COLLECT_TIMES (60 * 60)
+
 typedef struct AdminCollect {
     ECS_DECLARE_COMPONENT(AdminWorldStats);
     ECS_DECLARE_COMPONENT(AdminMemoryStats);
     ECS_DECLARE_COMPONENT(AdminSystemStats);
     ECS_DECLARE_COMPONENT(AdminComponentStats);
+    ECS_DECLARE_COMPONENT(AdminMetricStats);
+    ECS_DECLARE_COMPONENT(AdminCollectConfig);
+    ECS_DECLARE_ENTITY(AdminCollectMetrics);
     ECS_DECLARE_ENTITY(AdminCollectSystems);
 } AdminCollect;
 
@@ -77,4 +207,7 @@ void AdminCollectImport(
     ECS_IMPORT_COMPONENT(handles, AdminMemoryStats);\
     ECS_IMPORT_COMPONENT(handles, AdminSystemStats);\
     ECS_IMPORT_COMPONENT(handles, AdminComponentStats);\
+    ECS_IMPORT_COMPONENT(handles, AdminMetricStats);\
+    ECS_IMPORT_COMPONENT(handles, AdminCollectConfig);\
+    ECS_IMPORT_ENTITY(handles, AdminCollectMetrics);\
     ECS_IMPORT_ENTITY(handles, AdminCollectSystems);
@@ -0,0 +1,716 @@
+#include <flecs_systems_admin.h>
+#include "collect.h"
+#include "export.h"
+#include "util.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Metric of a statistics component that can be exported */
+typedef struct export_metric_t {
+    const char *name;
+    size_t offset;          /* Offset of admin_stat_t in component */
+} export_metric_t;
+
+static
+const export_metric_t world_metrics[] = {
+    {"fps", offsetof(AdminWorldStats, fps)},
+    {"frame", offsetof(AdminWorldStats, frame)},
+    {"system", offsetof(AdminWorldStats, system)},
+    {"merge", offsetof(AdminWorldStats, merge)},
+    {"entity_rate", offsetof(AdminWorldStats, entity_rate)},
+    {"table_rate", offsetof(AdminWorldStats, table_rate)},
+    {"component_churn", offsetof(AdminWorldStats, component_churn)},
+    {"table_match_rate", offsetof(AdminWorldStats, table_match_rate)},
+    {"table_match_tests", offsetof(AdminWorldStats, table_match_tests)},
+    {"frame_overhead", offsetof(AdminWorldStats, frame_overhead)},
+    {"alloc_rate", offsetof(AdminWorldStats, alloc_rate)},
+    {"alloc_bytes_rate", offsetof(AdminWorldStats, alloc_bytes_rate)},
+    {"free_rate", offsetof(AdminWorldStats, free_rate)}
+};
+
+/* Memory metrics export the memory in use */
+static
+const export_metric_t memory_metrics[] = {
+    {"total", offsetof(AdminMemoryStats, total.used)},
+    {"entities", offsetof(AdminMemoryStats, entities.used)},
+    {"components", offsetof(AdminMemoryStats, components.used)},
+    {"systems", offsetof(AdminMemoryStats, systems.used)},
+    {"types", offsetof(AdminMemoryStats, types.used)},
+    {"stages", offsetof(AdminMemoryStats, stages.used)},
+    {"tables", offsetof(AdminMemoryStats, tables.used)},
+    {"world", offsetof(AdminMemoryStats, world.used)}
+};
+
+static
+const export_metric_t system_metrics[] = {
+    {"time_spent", offsetof(AdminSystemStats, time_spent)},
+    {"time_spent_pct", offsetof(AdminSystemStats, time_spent_pct)},
+    {"tables_matched", offsetof(AdminSystemStats, tables_matched)},
+    {"entities_matched", offsetof(AdminSystemStats, entities_matched)},
+    {"activation_rate", offsetof(AdminSystemStats, activation_rate)}
+};
+
+static
+const export_metric_t component_metrics[] = {
+    {"memory", offsetof(AdminComponentStats, memory.used)},
+    {"entity_rate", offsetof(AdminComponentStats, entity_rate)}
+};
+
+static
+const export_metric_t metric_metrics[] = {
+    {"value", offsetof(AdminMetricStats, value)}
+};
+
+#define METRIC_COUNT(metrics) (sizeof(metrics) / sizeof(export_metric_t))
+
+static
+const char *kind_names[] = {
+    "world", "memory", "system", "component", "metric"
+};
+
+/* Row of an export. Minute rows aggregate the samples of a minute. */
+typedef struct export_row_t {
+    double time;
+    double value;
+    bool is_minute;
+    double min;
+    double max;
+    double stddev;
+} export_row_t;
+
+static
+void write_row(
+    admin_export_t *export,
+    admin_export_kind_t kind,
+    const char *entity,
+    const char *metric,
+    export_row_t *row)
+{
+    ecs_strbuf_t *buf = export->buf;
+
+    /* Rows before the cursor were returned by a previous page */
+    if (export->has_cursor && export->metric == export->cursor_metric &&
+        row->time <= export->cursor_time)
+    {
+        return;
+    }
+
+    if (export->row_count == export->limit) {
+        export->more = true;
+        return;
+    }
+
+    if (export->format == AdminExportCsv) {
+        ecs_strbuf_append(buf, "%s,", kind_names[kind]);
+        admin_append_csv_field(buf, entity);
+        ecs_strbuf_appendstr(buf, ",");
+        admin_append_csv_field(buf, metric);
+        ecs_strbuf_append(buf, ",%.3f,%f", row->time, row->value);
+        if (row->is_minute) {
+            ecs_strbuf_append(buf, ",%f,%f,%f\n",
+                row->min, row->max, row->stddev);
+        } else {
+            ecs_strbuf_appendstr(buf, ",,,\n");
+        }
+    } else {
+        ecs_strbuf_append(buf, "{\"kind\":\"%s\",\"entity\":",
+            kind_names[kind]);
+        admin_append_json_string(buf, entity);
+        ecs_strbuf_appendstr(buf, ",\"metric\":");
+        admin_append_json_string(buf, metric);
+        ecs_strbuf_append(buf, ",\"time\":%.3f,\"value\":%f",
+            row->time, row->value);
+        if (row->is_minute) {
+            ecs_strbuf_append(buf,
+                ",\"min\":%f,\"max\":%f,\"stddev\":%f",
+                row->min, row->max, row->stddev);
+        }
+        ecs_strbuf_appendstr(buf, "}\n");
+    }
+
+    export->row_count ++;
+    export->last_metric = export->metric;
+    export->last_time = row->time;
+}
+
+/* Get the unix time of the sample that was added age collections before the
+ * newest sample. Returns false if the time of the collection is no longer
+ * stored. */
+static
+bool sample_time(
+    admin_export_t *export,
+    uint32_t age,
+    double *time_out)
+{
+    uint32_t count = admin_series_count(export->collect_times);
+    if (age >= count) {
+        return false;
+    }
+
+    *time_out = admin_series_get(export->collect_times, count - age - 1);
+    return true;
+}
+
+/* Write samples of the last minute, each with the time of the collection at
+ * which it was added */
+static
+void write_samples(
+    admin_export_t *export,
+    admin_export_kind_t kind,
+    const char *entity,
+    const char *metric,
+    admin_stat_t *stat)
+{
+    export_row_t row = {0};
+
+    /* Only the current value is tracked until history is allocated */
+    if (!stat->data_1m) {
+        row.time = export->collect_time;
+        row.value = stat->current;
+        if (row.time >= export->from && row.time <= export->to) {
+            write_row(export, kind, entity, metric, &row);
+        }
+        return;
+    }
+
+    admin_series_iter_t it = admin_series_iter(stat->data_1m);
+    while (admin_series_next(&it)) {
+        if (!sample_time(export, it.count - it.index, &row.time)) {
+            continue;
+        }
+        if (row.time < export->from || row.time > export->to) {
+            continue;
+        }
+
+        row.value = it.value;
+        write_row(export, kind, entity, metric, &row);
+    }
+}
+
+/* Write per-minute averages of the last hour. Minutes start at the sample at
+ * which the 1m series wraps around, so the newest minute may be incomplete.
+ * The time of a row is the time of the first sample of its minute. */
+static
+void write_minutes(
+    admin_export_t *export,
+    admin_export_kind_t kind,
+    const char *entity,
+    const char *metric,
+    admin_stat_t *stat)
+{
+    if (!stat->data_1m || !admin_series_count(stat->data_1m)) {
+        return;
+    }
+
+    uint32_t size = stat->data_1m->size;
+    uint32_t current = admin_series_index(stat->data_1m);
+    if (!current) {
+        current = size;
+    }
+
+    /* Age of the first sample of the newest minute */
+    uint32_t newest = current - 1;
+
+    /* Series of the hour are pushed together, and have the same count */
+    admin_series_iter_t avg = admin_series_iter(stat->data_1h);
+    admin_series_iter_t min = admin_series_iter(stat->min_1h);
+    admin_series_iter_t max = admin_series_iter(stat->max_1h);
+    admin_series_iter_t stddev = admin_series_iter(stat->stddev_1h);
+
+    export_row_t row = {.is_minute = true};
+
+    while (admin_series_next(&avg) && admin_series_next(&min) &&
+        admin_series_next(&max) && admin_series_next(&stddev))
+    {
+        uint32_t age = newest + (avg.count - avg.index) * size;
+        if (!sample_time(export, age, &row.time)) {
+            continue;
+        }
+
+        /* A minute ends where the next minute starts */
+        double end = export->collect_time;
+        if (age >= size) {
+            sample_time(export, age - size, &end);
+        }
+
+        if (end <= export->from || row.time > export->to) {
+            continue;
+        }
+
+        row.value = avg.value;
+        row.min = min.value;
+        row.max = max.value;
+        row.stddev = stddev.value;
+        write_row(export, kind, entity, metric, &row);
+    }
+}
+
+static
+bool match_name(
+    const char *pattern,
+    const char *name)
+{
+    if (!name) {
+        return false;
+    }
+
+    return !strcmp(pattern, "*") || !strcmp(pattern, name);
+}
+
+/* A metric is exported once, even if it is matched by multiple selectors */
+static
+bool is_selected(
+    admin_export_t *export,
+    admin_export_kind_t kind,
+    const char *entity,
+    const char *metric)
+{
+    uint32_t i;
+    for (i = 0; i < export->selector_count; i ++) {
+        admin_export_selector_t *s = &export->selectors[i];
+        if (s->kind == kind && match_name(s->entity, entity) &&
+            match_name(s->metric, metric))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+bool has_kind(
+    admin_export_t *export,
+    admin_export_kind_t kind)
+{
+    uint32_t i;
+    for (i = 0; i < export->selector_count; i ++) {
+        if (export->selectors[i].kind == kind) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+void write_metrics(
+    admin_export_t *export,
+    admin_export_kind_t kind,
+    const char *entity,
+    const export_metric_t *metrics,
+    uint32_t metric_count,
+    void *admin_stats)
+{
+    uint32_t i;
+    for (i = 0; i < metric_count; i ++) {
+        if (export->more) {
+            return;
+        }
+
+        if (!is_selected(export, kind, entity, metrics[i].name)) {
+            continue;
+        }
+
+        /* Metrics before the metric of the cursor were returned already */
+        export->metric = export->metric_count ++;
+        if (export->has_cursor && export->metric < export->cursor_metric) {
+            continue;
+        }
+
+        admin_stat_t *stat = (admin_stat_t*)
+            ((char*)admin_stats + metrics[i].offset);
+
+        if (export->resolution == AdminExportMinute) {
+            write_minutes(export, kind, entity, metrics[i].name, stat);
+        } else {
+            write_samples(export, kind, entity, metrics[i].name, stat);
+        }
+    }
+}
+
+/* Runs before the other export systems, as it resolves the range of the
+ * export from the time of the last collection */
+static
+void AdminExportWorldStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, AdminWorldStats, admin_stats, 1);
+
+    admin_export_t *export = rows->param;
+
+    /* Nothing has been collected yet, so there is nothing to export */
+    if (!admin_stats->collect_time) {
+        export->selector_count = 0;
+        return;
+    }
+
+    export->collect_time = admin_stats->collect_time;
+    export->collect_times = admin_stats->collect_times;
+
+    if (export->from <= 0) {
+        export->from += export->collect_time;
+    }
+    if (export->to <= 0) {
+        export->to += export->collect_time;
+    }
+
+    /* Samples cover the range if it starts after the oldest sample */
+    if (export->resolution == AdminExportAuto) {
+        uint32_t count = admin_series_count(admin_stats->fps.data_1m);
+        double oldest;
+
+        export->resolution = count && 
+            sample_time(export, count - 1, &oldest) && export->from >= oldest
+            ? AdminExportSample
+            : AdminExportMinute
+            ;
+    }
+
+    write_metrics(export, AdminExportWorld, "", world_metrics,
+        METRIC_COUNT(world_metrics), admin_stats);
+}
+
+static
+void AdminExportMemoryStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, AdminMemoryStats, admin_stats, 1);
+
+    admin_export_t *export = rows->param;
+
+    if (has_kind(export, AdminExportMemory)) {
+        write_metrics(export, AdminExportMemory, "", memory_metrics,
+            METRIC_COUNT(memory_metrics), admin_stats);
+    }
+}
+
+static
+void AdminExportSystemStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsSystemStats, stats, 1);
+    ECS_COLUMN(rows, AdminSystemStats, admin_stats, 2);
+
+    admin_export_t *export = rows->param;
+
+    if (!has_kind(export, AdminExportSystem)) {
+        return;
+    }
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        write_metrics(export, AdminExportSystem, stats[i].name, system_metrics,
+            METRIC_COUNT(system_metrics), &admin_stats[i]);
+    }
+}
+
+static
+void AdminExportComponentStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsComponentStats, stats, 1);
+    ECS_COLUMN(rows, AdminComponentStats, admin_stats, 2);
+
+    admin_export_t *export = rows->param;
+
+    if (!has_kind(export, AdminExportComponent)) {
+        return;
+    }
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        write_metrics(export, AdminExportComponent, stats[i].name,
+            component_metrics, METRIC_COUNT(component_metrics),
+            &admin_stats[i]);
+    }
+}
+
+static
+void AdminExportMetricStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsAdminMetric, metric, 1);
+    ECS_COLUMN(rows, AdminMetricStats, admin_stats, 2);
+
+    admin_export_t *export = rows->param;
+
+    if (!has_kind(export, AdminExportMetric)) {
+        return;
+    }
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        const char *name = metric[i].name
+            ? metric[i].name
+            : ecs_get_id(rows->world, rows->entities[i]);
+
+        write_metrics(export, AdminExportMetric, name, metric_metrics,
+            METRIC_COUNT(metric_metrics), &admin_stats[i]);
+    }
+}
+
+static
+void AdminExportHistory(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminExportWorldStats, 1);
+    ECS_COLUMN_ENTITY(rows, AdminExportMemoryStats, 2);
+    ECS_COLUMN_ENTITY(rows, AdminExportSystemStats, 3);
+    ECS_COLUMN_ENTITY(rows, AdminExportComponentStats, 4);
+    ECS_COLUMN_ENTITY(rows, AdminExportMetricStats, 5);
+
+    ecs_world_t *world = rows->world;
+    admin_export_t *export = rows->param;
+
+    /* Only the first page has a header */
+    if (export->format == AdminExportCsv && !export->has_cursor) {
+        ecs_strbuf_appendstr(export->buf,
+            "kind,entity,metric,time,value,min,max,stddev\n");
+    }
+
+    ecs_run(world, AdminExportWorldStats, 0, export);
+    ecs_run(world, AdminExportMemoryStats, 0, export);
+    ecs_run(world, AdminExportSystemStats, 0, export);
+    ecs_run(world, AdminExportComponentStats, 0, export);
+    ecs_run(world, AdminExportMetricStats, 0, export);
+}
+
+/* Parse selector of the form <kind>.<metric> for world and memory metrics,
+ * <kind>.<entity>.<metric> for systems and components, and metric.<name> for
+ * application-defined metrics */
+static
+bool parse_selector(
+    const char *str,
+    size_t len,
+    admin_export_selector_t *selector)
+{
+    const char *dot = memchr(str, '.', len);
+    if (!dot) {
+        return false;
+    }
+
+    size_t kind_len = dot - str;
+    const char *rest = dot + 1;
+    size_t rest_len = len - kind_len - 1;
+
+    uint32_t kind;
+    for (kind = 0; kind <= AdminExportMetric; kind ++) {
+        if (strlen(kind_names[kind]) == kind_len &&
+            !strncmp(str, kind_names[kind], kind_len))
+        {
+            break;
+        }
+    }
+
+    if (kind > AdminExportMetric) {
+        return false;
+    }
+
+    const char *entity = "", *metric = rest;
+    size_t entity_len = 0, metric_len = rest_len;
+
+    if (kind == AdminExportMetric) {
+        entity = rest;
+        entity_len = rest_len;
+        metric = "value";
+        metric_len = strlen(metric);
+    } else if (kind == AdminExportSystem || kind == AdminExportComponent) {
+        /* Entity names may contain dots, metric names do not */
+        const char *last = NULL, *ptr;
+        for (ptr = rest; ptr < rest + rest_len; ptr ++) {
+            if (*ptr == '.') {
+                last = ptr;
+            }
+        }
+
+        if (!last) {
+            return false;
+        }
+
+        entity = rest;
+        entity_len = last - rest;
+        metric = last + 1;
+        metric_len = rest_len - entity_len - 1;
+
+        if (!entity_len) {
+            return false;
+        }
+    }
+
+    if (!metric_len || entity_len >= ADMIN_EXPORT_NAME_SIZE ||
+        metric_len >= ADMIN_EXPORT_NAME_SIZE)
+    {
+        return false;
+    }
+
+    selector->kind = kind;
+    memcpy(selector->entity, entity, entity_len);
+    selector->entity[entity_len] = '\0';
+    memcpy(selector->metric, metric, metric_len);
+    selector->metric[metric_len] = '\0';
+
+    return true;
+}
+
+static
+bool parse_time(
+    const char *params,
+    const char *name,
+    double *value_out)
+{
+    char buf[32];
+    if (!admin_http_param(params, name, buf, sizeof(buf))) {
+        return true;
+    }
+
+    char *end;
+    double value = strtod(buf, &end);
+    if (end == buf || *end) {
+        return false;
+    }
+
+    *value_out = value;
+    return true;
+}
+
+bool admin_export_parse(
+    const char *params,
+    admin_export_t *export)
+{
+    char list[ADMIN_EXPORT_MAX_SELECTORS * 64], value[32];
+    char cursor[ADMIN_EXPORT_CURSOR_SIZE];
+
+    *export = (admin_export_t){
+        .format = AdminExportNdjson,
+        .resolution = AdminExportAuto,
+        .from = -ADMIN_EXPORT_DEFAULT_RANGE,
+        .limit = ADMIN_EXPORT_DEFAULT_LIMIT
+    };
+
+    if (!admin_http_param(params, "metric", list, sizeof(list))) {
+        return false;
+    }
+
+    const char *ptr = list;
+    while (*ptr) {
+        const char *end = strchr(ptr, ',');
+        size_t len = end ? (size_t)(end - ptr) : strlen(ptr);
+
+        if (export->selector_count == ADMIN_EXPORT_MAX_SELECTORS) {
+            return false;
+        }
+
+        if (!parse_selector(ptr, len,
+            &export->selectors[export->selector_count]))
+        {
+            return false;
+        }
+
+        export->selector_count ++;
+        ptr = end ? end + 1 : ptr + len;
+    }
+
+    if (!export->selector_count) {
+        return false;
+    }
+
+    if (!parse_time(params, "from", &export->from) ||
+        !parse_time(params, "to", &export->to))
+    {
+        return false;
+    }
+
+    if (admin_http_param(params, "resolution", value, sizeof(value))) {
+        if (!strcmp(value, "sample")) {
+            export->resolution = AdminExportSample;
+        } else if (!strcmp(value, "minute")) {
+            export->resolution = AdminExportMinute;
+        } else if (strcmp(value, "auto")) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "format", value, sizeof(value))) {
+        if (!strcmp(value, "csv")) {
+            export->format = AdminExportCsv;
+        } else if (strcmp(value, "ndjson")) {
+            return false;
+        }
+    }
+
+    if (admin_http_param(params, "limit", value, sizeof(value))) {
+        if (!admin_http_param_uint(params, "limit", &export->limit) ||
+            !export->limit)
+        {
+            return false;
+        }
+
+        if (export->limit > ADMIN_EXPORT_MAX_LIMIT) {
+            export->limit = ADMIN_EXPORT_MAX_LIMIT;
+        }
+    }
+
+    /* The cursor has the resolved range and resolution of the first page, so
+     * that pages do not move along with new collections */
+    if (admin_http_param(params, "cursor", cursor, sizeof(cursor))) {
+        unsigned int resolution;
+        int len = 0;
+        if (sscanf(cursor, "%lf,%lf,%u,%u,%lf%n", &export->from, &export->to,
+                &resolution, &export->cursor_metric, &export->cursor_time,
+                &len) != 5 || cursor[len] || 
+            export->from <= 0 || export->to <= 0 ||
+            (resolution != AdminExportSample && 
+                resolution != AdminExportMinute))
+        {
+            return false;
+        }
+
+        export->resolution = resolution;
+
+        export->has_cursor = true;
+    }
+
+    return true;
+}
+
+bool admin_export_cursor(
+    admin_export_t *export,
+    char *buf,
+    size_t size)
+{
+    if (!export->more) {
+        return false;
+    }
+
+    /* Times are written with enough digits to be read back exactly */
+    int len = snprintf(buf, size, "%.17g,%.17g,%u,%u,%.17g", export->from,
+        export->to, export->resolution, export->last_metric,
+        export->last_time);
+
+    return len > 0 && (size_t)len < size;
+}
+
+void AdminExportImport(
+    ecs_world_t *world,
+    int flags)
+{
+    ECS_MODULE(world, AdminExport);
+
+    /* Write history of selected metrics to the export that is passed as param */
+    ECS_SYSTEM(world, AdminExportWorldStats, EcsManual, [in] AdminWorldStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminExportMemoryStats, EcsManual, [in] AdminMemoryStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminExportSystemStats, EcsManual, [in] EcsSystemStats, [in] AdminSystemStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminExportComponentStats, EcsManual, [in] EcsComponentStats, [in] AdminComponentStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminExportMetricStats, EcsManual, [in] EcsAdminMetric, [in] AdminMetricStats,
+        SYSTEM.EcsHidden);
+
+    /* Export history of all selected metrics */
+    ECS_SYSTEM(world, AdminExportHistory, EcsManual,
+        .AdminExportWorldStats,
+        .AdminExportMemoryStats,
+        .AdminExportSystemStats,
+        .AdminExportComponentStats,
+        .AdminExportMetricStats,
+        SYSTEM.EcsHidden);
+
+    ECS_EXPORT_ENTITY(AdminExportHistory);
+}
@@ -0,0 +1,111 @@
+#include <flecs_systems_admin.h>
+
+/* The AdminExport module writes the history of selected metrics as rows of
+ * samples, for analysis outside of the dashboard. Rows are written directly
+ * from the series of a metric into a buffer, so that an export does not build
+ * intermediate lists, regardless of how many metrics are selected.
+ *
+ * The HTTP server needs the complete body of a reply, so an export is returned
+ * in pages of at most limit rows. When rows remain, the export returns a cursor
+ * with which the next page is requested. */
+
+/* Maximum number of selectors in a single export */
+#define ADMIN_EXPORT_MAX_SELECTORS (16)
+
+/* Maximum length of the entity and metric name of a selector, including the
+ * terminating 0 */
+#define ADMIN_EXPORT_NAME_SIZE (128)
+
+/* Default range of an export, in seconds before the last collection */
+#define ADMIN_EXPORT_DEFAULT_RANGE (3600)
+
+/* Default and maximum number of rows in a page of an export */
+#define ADMIN_EXPORT_DEFAULT_LIMIT (10000)
+#define ADMIN_EXPORT_MAX_LIMIT (100000)
+
+/* Maximum length of a cursor, including the terminating 0 */
+#define ADMIN_EXPORT_CURSOR_SIZE (96)
+
+typedef enum admin_export_kind_t {
+    AdminExportWorld,
+    AdminExportMemory,
+    AdminExportSystem,
+    AdminExportComponent,
+    AdminExportMetric
+} admin_export_kind_t;
+
+typedef enum admin_export_format_t {
+    AdminExportNdjson,
+    AdminExportCsv
+} admin_export_format_t;
+
+typedef enum admin_export_resolution_t {
+    AdminExportAuto,        /* Samples if they cover the range, else minutes */
+    AdminExportSample,      /* Samples of the last minute */
+    AdminExportMinute       /* Per-minute averages of the last hour */
+} admin_export_resolution_t;
+
+/* Selects metrics of a kind. An entity or metric of "*" matches all. World and
+ * memory metrics have no entity, and application-defined metrics are selected
+ * by name only. */
+typedef struct admin_export_selector_t {
+    admin_export_kind_t kind;
+    char entity[ADMIN_EXPORT_NAME_SIZE];
+    char metric[ADMIN_EXPORT_NAME_SIZE];
+} admin_export_selector_t;
+
+/* Parameter passed to the AdminExportHistory system */
+typedef struct admin_export_t {
+    ecs_strbuf_t *buf;
+    admin_export_format_t format;
+    admin_export_resolution_t resolution;
+    admin_export_selector_t selectors[ADMIN_EXPORT_MAX_SELECTORS];
+    uint32_t selector_count;
+
+    /* Range in unix time. Values of 0 or less are relative to the last
+     * collection, and are resolved when the export runs. */
+    double from;
+    double to;
+
+    /* Rows of a metric are written in order of time, and metrics are written
+     * in the order in which they are matched. A cursor resumes after the row
+     * with cursor_time of the metric with index cursor_metric. */
+    uint32_t limit;
+    bool has_cursor;
+    uint32_t cursor_metric;
+    double cursor_time;
+
+    /* Set by the export from the world statistics */
+    double collect_time;            /* Unix time of the last collection */
+    admin_series_t *collect_times;  /* Unix time of each collection */
+    uint32_t row_count;
+    uint32_t metric_count;          /* Number of metrics matched so far */
+    uint32_t metric;                /* Index of the metric being written */
+    uint32_t last_metric;           /* Metric of the last row written */
+    double last_time;               /* Time of the last row written */
+    bool more;                      /* Set if rows did not fit in the page */
+} admin_export_t;
+
+/* Parse metric, from, to, resolution, format, limit and cursor parameters.
+ * Returns false if a parameter is missing or has an invalid value. */
+bool admin_export_parse(
+    const char *params,
+    admin_export_t *export);
+
+/* Write the cursor of the next page of an export that has run into buf.
+ * Returns false if the export has no more rows. */
+bool admin_export_cursor(
+    admin_export_t *export,
+    char *buf,
+    size_t size);
+
+typedef struct AdminExport {
+    ECS_DECLARE_ENTITY(AdminExportHistory);
+} AdminExport;
+
+void AdminExportImport(
+    ecs_world_t *world,
+    int flags);
+
+#define AdminExportImportHandles(handles) \
+    ECS_IMPORT_ENTITY(handles, AdminExportHistory);
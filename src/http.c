@@ -1,25 +1,23 @@
 #include <flecs_systems_admin.h>
 #include "collect.h"
 #include "http.h"
+#include "alloc.h"
 
-static
-const ecs_vector_params_t double_params = {
-    .element_size = sizeof(double)
-};
-
+/* Samples are decoded while they are written, so compact series do not
+ * require a temporary buffer */
 static 
 void write_buffer(
     ecs_strbuf_t *reply,
-    ecs_ringbuf_t *buffer)
+    admin_series_t *series)
 {
-    uint32_t i, count = ecs_ringbuf_count(buffer);
     ecs_strbuf_list_push(reply, "[", ",");
 
-    for (i = 0; i < count; i ++) {
-        double *value = ecs_ringbuf_get(
-            buffer, &double_params, i);
-
-        ecs_strbuf_list_append(reply, "%f", *value);
+    /* Series is NULL if history has not been allocated yet */
+    if (series) {
+        admin_series_iter_t it = admin_series_iter(series);
+        while (admin_series_next(&it)) {
+            ecs_strbuf_list_append(reply, "%f", it.value);
+        }
     }
 
     ecs_strbuf_list_pop(reply, "]");
@@ -35,6 +33,8 @@ void write_admin_stat(
     
     ecs_strbuf_list_push     (reply, "{", ",");
     ecs_strbuf_list_append   (reply, "\"current\":%f", stat->current);
+    ecs_strbuf_list_append   (reply, "\"ewma\":%f", stat->ewma);
+    ecs_strbuf_list_append   (reply, "\"stddev\":%f", stat->stddev);
     ecs_strbuf_list_appendstr(reply, "\"data_1m\":");
     write_buffer(reply, stat->data_1m);
     ecs_strbuf_list_appendstr(reply, "\"data_1h\":");
@@ -43,9 +43,30 @@ void write_admin_stat(
     write_buffer(reply, stat->min_1h);
     ecs_strbuf_list_appendstr(reply, "\"max_1h\":");
     write_buffer(reply, stat->max_1h);
+    ecs_strbuf_list_appendstr(reply, "\"ewma_1m\":");
+    write_buffer(reply, stat->ewma_1m);
+    ecs_strbuf_list_appendstr(reply, "\"stddev_1m\":");
+    write_buffer(reply, stat->stddev_1m);
+    ecs_strbuf_list_appendstr(reply, "\"stddev_1h\":");
+    write_buffer(reply, stat->stddev_1h);
     ecs_strbuf_list_pop      (reply, "}");
 }
 
+static
+void write_trend(
+    ecs_strbuf_t *reply,
+    admin_trend_t *trend,
+    const char *trend_name)
+{
+    ecs_strbuf_list_append(reply, "\"%s\":", trend_name);
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_append(reply, "\"slope\":%f", trend->slope);
+    ecs_strbuf_list_append(reply, "\"r2\":%f", trend->r2);
+    ecs_strbuf_list_append(reply, "\"growing\":%s", 
+        trend->growing ? "true" : "false");
+    ecs_strbuf_list_pop(reply, "}");
+}
+
 static
 void write_memory_stat(
     ecs_strbuf_t *reply,
@@ -56,6 +77,67 @@ void write_memory_stat(
     ecs_strbuf_list_push(reply, "{", ",");
     write_admin_stat(reply, &stat->used, "used");
     write_admin_stat(reply, &stat->allocd, "allocd");
+    write_trend(reply, &stat->trend_1h, "trend_1h");
+    write_trend(reply, &stat->trend_long, "trend_long");
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+/* Project when memory in use reaches the memory limit, if memory is growing */
+static
+void write_memory_projection(
+    ecs_strbuf_t *reply,
+    admin_memory_stat_t *stat,
+    uint64_t memory_limit)
+{
+    ecs_strbuf_list_appendstr(reply, "\"projection\":");
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_append(reply, "\"limit\":%llu", 
+        (unsigned long long)memory_limit);
+
+    double slope = stat->trend_1h.slope;
+    if (memory_limit && stat->trend_1h.growing && slope > 0) {
+        double remaining = (double)memory_limit - stat->used.current;
+        ecs_strbuf_list_append(reply, "\"seconds_to_limit\":%f", 
+            remaining > 0 ? remaining / slope : 0);
+    } else {
+        ecs_strbuf_list_appendstr(reply, "\"seconds_to_limit\":null");
+    }
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+/* Names of phases, in the order of AdminWorldStats::phases */
+static
+const char *phase_names[ADMIN_PHASE_COUNT] = {
+    "on_load",
+    "post_load",
+    "pre_update",
+    "on_update",
+    "on_validate",
+    "post_update",
+    "pre_store",
+    "on_store",
+    "manual"
+};
+
+static
+void write_phase_stats(
+    ecs_strbuf_t *reply,
+    admin_phase_stat_t *phases)
+{
+    ecs_strbuf_list_appendstr(reply, "\"phases\":");
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    uint32_t i;
+    for (i = 0; i < ADMIN_PHASE_COUNT; i ++) {
+        ecs_strbuf_list_append(reply, "\"%s\":", phase_names[i]);
+        ecs_strbuf_list_push(reply, "{", ",");
+        write_admin_stat(reply, &phases[i].time_spent_pct, "time_spent_pct");
+        write_admin_stat(reply, &phases[i].invoke_count, "invoke_count");
+        write_admin_stat(reply, &phases[i].active_systems, "active_systems");
+        ecs_strbuf_list_pop(reply, "}");
+    }
+
     ecs_strbuf_list_pop(reply, "}");
 }
 
@@ -85,16 +167,41 @@ void AdminHttpReplyWorldStats(ecs_rows_t *rows) {
     write_admin_stat(reply, &admin_stats->frame, "frame");
     write_admin_stat(reply, &admin_stats->system, "system");
     write_admin_stat(reply, &admin_stats->merge, "merge");
+    write_admin_stat(reply, &admin_stats->entity_rate, "entity_rate");
+    write_admin_stat(reply, &admin_stats->table_rate, "table_rate");
+    write_admin_stat(reply, &admin_stats->component_churn, "component_churn");
+    write_admin_stat(reply, &admin_stats->table_match_rate, "table_match_rate");
+    write_admin_stat(reply, &admin_stats->table_match_tests, "table_match_tests");
+    write_admin_stat(reply, &admin_stats->frame_overhead, "frame_overhead");
+
+    ecs_strbuf_list_append(reply, "\"alloc_tracking\":%s", 
+        admin_alloc_enabled() ? "true" : "false");
+    write_admin_stat(reply, &admin_stats->alloc_rate, "alloc_rate");
+    write_admin_stat(reply, &admin_stats->alloc_bytes_rate, "alloc_bytes_rate");
+    write_admin_stat(reply, &admin_stats->free_rate, "free_rate");
+    write_phase_stats(reply, admin_stats->phases);
+
+    ecs_strbuf_list_append(reply, "\"history_count\":%u", 
+        admin_stats->history_count);
+    ecs_strbuf_list_append(reply, "\"history_deferred_count\":%u", 
+        admin_stats->history_deferred_count);
+    ecs_strbuf_list_append(reply, "\"history_bytes\":%llu", 
+        (unsigned long long)admin_stats->history_bytes);
+    ecs_strbuf_list_append(reply, "\"history_bytes_saved\":%llu", 
+        (unsigned long long)admin_stats->history_bytes_saved);
 }
 
 static
 void AdminHttpReplyMemoryStats(ecs_rows_t *rows) {
     ECS_COLUMN(rows, AdminMemoryStats, admin_stats, 1);
 
-    ecs_strbuf_t *reply = rows->param;
+    admin_reply_t *params = rows->param;
+    ecs_strbuf_t *reply = params->buf;
 
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
+        write_memory_projection(
+            reply, &admin_stats[i].total, params->memory_limit);
         write_memory_stat(reply, &admin_stats[i].total, "total");
         write_memory_stat(reply, &admin_stats[i].entities, "entities");
         write_memory_stat(reply, &admin_stats[i].components, "components");
@@ -106,6 +213,34 @@ void AdminHttpReplyMemoryStats(ecs_rows_t *rows) {
     }
 }
 
+static
+void AdminHttpReplyMetricStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsAdminMetric, metric, 1);
+    ECS_COLUMN(rows, AdminMetricStats, admin_stats, 2);
+
+    ecs_strbuf_t *reply = rows->param;
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_strbuf_list_next(reply);
+        ecs_strbuf_list_push(reply, "{", ",");
+
+        ecs_strbuf_list_appendstr(reply, "\"name\":");
+        admin_append_json_string(reply,
+            metric[i].name ? metric[i].name : ecs_get_id(rows->world, rows->entities[i]));
+
+        ecs_strbuf_list_appendstr(reply, "\"unit\":");
+        admin_append_json_string(reply, metric[i].unit ? metric[i].unit : "");
+
+        ecs_strbuf_list_append(reply, "\"kind\":\"%s\"",
+            metric[i].kind == EcsAdminCounter ? "counter" : "gauge");
+
+        write_admin_stat(reply, &admin_stats[i].value, "value");
+
+        ecs_strbuf_list_pop(reply, "}");
+    }
+}
+
 static
 void write_system_stats(
     ecs_rows_t *rows,
@@ -114,11 +249,17 @@ void write_system_stats(
     ECS_COLUMN(rows, EcsSystemStats, stats, 1);
     ECS_COLUMN(rows, AdminSystemStats, admin_stats, 2);
 
-    ecs_strbuf_t *reply = rows->param;
+    admin_reply_t *params = rows->param;
+    ecs_strbuf_t *reply = params->buf;
 
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
         if (stats[i].kind == system_kind) {
+            /* History is allocated at the next collection */
+            if (stats[i].entity == params->history) {
+                admin_flag_set(&admin_stats[i].history_requested);
+            }
+
             ecs_strbuf_list_next(reply);
             ecs_strbuf_list_push(reply, "{", ",");
             ecs_strbuf_list_append(reply, "\"name\":\"%s\"",
@@ -151,8 +292,14 @@ void write_system_stats(
             ecs_strbuf_list_append(reply, "\"period\":%f",
                 stats[i].period_seconds);
 
+            ecs_strbuf_list_append(reply, "\"history\":%s",
+                admin_stats[i].time_spent.data_1m ? "true" : "false");
+
             write_admin_stat(reply, &admin_stats[i].time_spent, "time_spent");
             write_admin_stat(reply, &admin_stats[i].time_spent_pct, "time_spent_pct");
+            write_admin_stat(reply, &admin_stats[i].tables_matched, "tables_matched_stats");
+            write_admin_stat(reply, &admin_stats[i].entities_matched, "entities_matched_stats");
+            write_admin_stat(reply, &admin_stats[i].activation_rate, "activation_rate");
 
             ecs_strbuf_list_pop(reply, "}");
         }
@@ -217,51 +364,52 @@ void AdminHttpReplySystemStats(ecs_rows_t *rows) {
     ECS_COLUMN_ENTITY(rows, AdminHttpReplySystemManual, 9);
 
     ecs_world_t *world = rows->world;
-    ecs_strbuf_t *reply = rows->param;
+    admin_reply_t *params = rows->param;
+    ecs_strbuf_t *reply = params->buf;
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"on_load\":[", ",");
-    ecs_run(world, AdminHttpReplySystemOnLoad, 0, reply);
+    ecs_run(world, AdminHttpReplySystemOnLoad, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"post_load\":[", ",");
-    ecs_run(world, AdminHttpReplySystemPostLoad, 0, reply);
+    ecs_run(world, AdminHttpReplySystemPostLoad, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"pre_update\":[", ",");
-    ecs_run(world, AdminHttpReplySystemPreUpdate, 0, reply);
+    ecs_run(world, AdminHttpReplySystemPreUpdate, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"on_update\":[", ",");
-    ecs_run(world, AdminHttpReplySystemOnUpdate, 0, reply);
+    ecs_run(world, AdminHttpReplySystemOnUpdate, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"on_validate\":[", ",");
-    ecs_run(world, AdminHttpReplySystemOnValidate, 0, reply);
+    ecs_run(world, AdminHttpReplySystemOnValidate, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"post_update\":[", ",");
-    ecs_run(world, AdminHttpReplySystemPostUpdate, 0, reply);
+    ecs_run(world, AdminHttpReplySystemPostUpdate, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"pre_store\":[", ",");
-    ecs_run(world, AdminHttpReplySystemPreStore, 0, reply);
+    ecs_run(world, AdminHttpReplySystemPreStore, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"on_store\":[", ",");
-    ecs_run(world, AdminHttpReplySystemOnStore, 0, reply);
+    ecs_run(world, AdminHttpReplySystemOnStore, 0, params);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_next(reply);
     ecs_strbuf_list_push(reply, "\"manual\":[", ",");
-    ecs_run(world, AdminHttpReplySystemManual, 0, reply);
+    ecs_run(world, AdminHttpReplySystemManual, 0, params);
     ecs_strbuf_list_pop(reply, "]");    
 }
 
@@ -270,75 +418,514 @@ void AdminHttpReplyComponentStats(ecs_rows_t *rows) {
     ECS_COLUMN(rows, EcsComponentStats, stats, 1);
     ECS_COLUMN(rows, AdminComponentStats, admin_stats, 2);
 
-    ecs_strbuf_t *reply = rows->param;
+    admin_select_t *select = rows->param;
 
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
-        ecs_strbuf_list_next(reply);
-        ecs_strbuf_list_push(reply, "{", ",");
+        double key;
+
+        switch(select->page.sort) {
+        case AdminSortEntities:
+            key = stats[i].entities_count;
+            break;
+        case AdminSortTables:
+            key = stats[i].tables_count;
+            break;
+        case AdminSortChurn:
+            key = admin_stats[i].entity_rate.current;
+            if (key < 0) key = -key;
+            break;
+        default:
+            key = stats[i].memory.used_bytes;
+            break;
+        }
+
+        admin_select_add(
+            select, key, stats[i].entity, &stats[i], &admin_stats[i]);
+    }
+}
+
+static
+void AdminHttpReplyTypeStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsTypeStats, stats, 1);
+
+    admin_select_t *select = rows->param;
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        double key;
+
+        switch(select->page.sort) {
+        case AdminSortComponents:
+            key = stats[i].components_count;
+            break;
+        case AdminSortSystems:
+            key = stats[i].col_systems_count + stats[i].row_systems_count;
+            break;
+        default:
+            key = stats[i].entities_count + stats[i].entities_childof_count + 
+                stats[i].entities_instanceof_count;
+            break;
+        }
+
+        admin_select_add(select, key, stats[i].entity, &stats[i], NULL);
+    }
+}
 
-        ecs_strbuf_list_append(reply, "\"name\":\"%s\"",
-            stats[i].name);
+static
+void write_component(
+    ecs_strbuf_t *reply,
+    EcsComponentStats *stats,
+    AdminComponentStats *admin_stats)
+{
+    ecs_strbuf_list_next(reply);
+    ecs_strbuf_list_push(reply, "{", ",");
 
-        ecs_strbuf_list_append(reply, "\"entity\":%u",
-            stats[i].entity);
+    ecs_strbuf_list_append(reply, "\"name\":\"%s\"",
+        stats->name);
 
-        ecs_strbuf_list_append(reply, "\"entity_count\":%d",
-            stats[i].entities_count);
+    ecs_strbuf_list_append(reply, "\"entity\":%u",
+        stats->entity);
 
-        ecs_strbuf_list_append(reply, "\"table_count\":%d",
-            stats[i].tables_count);
+    ecs_strbuf_list_append(reply, "\"entity_count\":%d",
+        stats->entities_count);
 
-        write_memory_stat(reply, &admin_stats[i].memory, "memory");
+    ecs_strbuf_list_append(reply, "\"table_count\":%d",
+        stats->tables_count);
 
-        ecs_strbuf_list_pop(reply, "}");
+    ecs_strbuf_list_append(reply, "\"history\":%s",
+        admin_stats->entity_rate.data_1m ? "true" : "false");
+
+    write_memory_stat(reply, &admin_stats->memory, "memory");
+    write_admin_stat(reply, &admin_stats->entity_rate, "entity_rate");
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+static
+void write_type(
+    ecs_strbuf_t *reply,
+    EcsTypeStats *stats)
+{
+    ecs_strbuf_list_next(reply);
+    ecs_strbuf_list_push(reply, "{", ",");
+    
+    ecs_strbuf_list_append(reply, "\"name\":\"%s\"",
+        stats->name);
+
+    ecs_strbuf_list_append(reply, "\"entity\":%u",
+        stats->entity);
+
+    ecs_strbuf_list_append(reply, "\"is_hidden\":%u",
+        stats->is_hidden);
+
+    ecs_strbuf_list_append(reply, "\"entity_count\":%u",
+        stats->entities_count + stats->entities_childof_count + 
+        stats->entities_instanceof_count); 
+
+    ecs_strbuf_list_append(reply, "\"component_count\":%u",
+        stats->components_count);
+
+    ecs_strbuf_list_append(reply, "\"col_system_count\":%u",
+        stats->col_systems_count); 
+
+    ecs_strbuf_list_append(reply, "\"row_system_count\":%u",
+        stats->row_systems_count); 
+
+    ecs_strbuf_list_append(reply, "\"enabled_system_count\":%u",
+        stats->enabled_systems_count);
+
+    ecs_strbuf_list_append(reply, "\"active_system_count\":%u",
+        stats->active_systems_count);
+
+    ecs_strbuf_list_append(reply, "\"instance_count\":%u",
+        stats->instance_count);
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+/* Write a page of components or types as a JSON array. Elements are collected
+ * by running the collect system, after which only the elements on the page are
+ * sorted and written. Returns the total number of elements. */
+static
+uint32_t write_page(
+    ecs_world_t *world,
+    ecs_entity_t collect,
+    admin_page_t *page,
+    bool is_component,
+    ecs_strbuf_t *reply)
+{
+    admin_select_t select;
+    admin_select_init(&select, page);
+
+    ecs_run(world, collect, 0, &select);
+
+    uint32_t i, count;
+    admin_select_elem_t *elems = admin_select_page(&select, &count);
+
+    ecs_strbuf_list_push(reply, "[", ",");
+    for (i = 0; i < count; i ++) {
+        if (is_component) {
+            write_component(reply, elems[i].stats, elems[i].admin_stats);
+        } else {
+            write_type(reply, elems[i].stats);
+        }
     }
+    ecs_strbuf_list_pop(reply, "]");
+
+    uint32_t total = admin_select_count(&select);
+
+    admin_select_deinit(&select);
+
+    return total;
 }
 
+/* Write the information a client needs to request the next page */
 static
-void AdminHttpReplyTypeStats(ecs_rows_t *rows) {
-    ECS_COLUMN(rows, EcsTypeStats, stats, 1);
+void write_cursor(
+    ecs_strbuf_t *reply,
+    admin_page_t *page,
+    uint32_t total)
+{
+    uint32_t next = page->cursor + page->limit;
+    ecs_strbuf_list_append(reply, "\"count\":%u", total);
+    ecs_strbuf_list_append(reply, "\"cursor\":%u", page->cursor);
+
+    if (page->limit && next < total) {
+        ecs_strbuf_list_append(reply, "\"next_cursor\":%u", next);
+    } else {
+        ecs_strbuf_list_appendstr(reply, "\"next_cursor\":null");
+    }
+}
 
-    ecs_strbuf_t *reply = rows->param;
+/* Write a page as JSON object, with the information required to request the
+ * next page. */
+static
+void write_page_object(
+    ecs_world_t *world,
+    ecs_entity_t collect,
+    admin_page_t *page,
+    bool is_component,
+    const char *member,
+    ecs_strbuf_t *reply)
+{
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    ecs_strbuf_list_append(reply, "\"%s\":", member);
+    uint32_t total = write_page(world, collect, page, is_component, reply);
+
+    write_cursor(reply, page, total);
+
+    ecs_strbuf_list_pop(reply, "}");
+}
+
+/* Components that are requested get history at the next collection, even if
+ * they are not used. Replies are written by HTTP threads, so the flag is set
+ * atomically. */
+static
+void AdminHttpRequestComponentHistory(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsComponentStats, stats, 1);
+    ECS_COLUMN(rows, AdminComponentStats, admin_stats, 2);
+
+    ecs_entity_t *history = rows->param;
 
     uint32_t i;
     for (i = 0; i < rows->count; i ++) {
-        ecs_strbuf_list_next(reply);
-        ecs_strbuf_list_push(reply, "{", ",");
-        
-        ecs_strbuf_list_append(reply, "\"name\":\"%s\"",
-            stats[i].name);
+        if (stats[i].entity == *history) {
+            admin_flag_set(&admin_stats[i].history_requested);
+        }
+    }
+}
 
-        ecs_strbuf_list_append(reply, "\"entity\":%u",
-            stats[i].entity);
+static
+void AdminHttpReplyComponents(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyComponentStats, 1);
+    ECS_COLUMN_ENTITY(rows, AdminHttpRequestComponentHistory, 2);
 
-        ecs_strbuf_list_append(reply, "\"is_hidden\":%u",
-            stats[i].is_hidden);
+    admin_reply_t *reply = rows->param;
 
-        ecs_strbuf_list_append(reply, "\"entity_count\":%u",
-            stats[i].entities_count + stats[i].entities_childof_count + 
-            stats[i].entities_instanceof_count); 
+    if (reply->history) {
+        ecs_run(rows->world, AdminHttpRequestComponentHistory, 0, 
+            &reply->history);
+    }
 
-        ecs_strbuf_list_append(reply, "\"component_count\":%u",
-            stats[i].components_count);
+    write_page_object(rows->world, AdminHttpReplyComponentStats, 
+        &reply->components, true, "components", reply->buf);
+}
 
-        ecs_strbuf_list_append(reply, "\"col_system_count\":%u",
-            stats[i].col_systems_count); 
+static
+void AdminHttpReplyTypes(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyTypeStats, 1);
 
-        ecs_strbuf_list_append(reply, "\"row_system_count\":%u",
-            stats[i].row_systems_count); 
+    admin_reply_t *reply = rows->param;
 
-        ecs_strbuf_list_append(reply, "\"enabled_system_count\":%u",
-            stats[i].enabled_systems_count);
+    write_page_object(rows->world, AdminHttpReplyTypeStats, 
+        &reply->types, false, "types", reply->buf);
+}
 
-        ecs_strbuf_list_append(reply, "\"active_system_count\":%u",
-            stats[i].active_systems_count);
+/* Statistics of a single table. Table statistics are not tracked by FlecsStats,
+ * so they are collected when requested by visiting all tables. */
+typedef struct admin_table_stat_t {
+    ecs_type_t type;
+    uint32_t row_count;
+    uint32_t row_size;
+    uint32_t capacity;          /* Rows allocated in the columns of the table */
+    uint64_t memory_allocd;     /* Bytes allocated by the columns of the table */
+} admin_table_stat_t;
+
+/* Parameter passed to the systems that collect table statistics. Systems only
+ * visit non-empty tables, so the number of tables and the memory of all tables
+ * are taken from FlecsStats, which does include empty tables. */
+typedef struct admin_table_totals_t {
+    ecs_vector_t *tables;       /* Non-empty tables */
+    uint32_t table_count;       /* All tables, including empty tables */
+    uint64_t memory_used;
+    uint64_t memory_allocd;
+} admin_table_totals_t;
 
-        ecs_strbuf_list_append(reply, "\"instance_count\":%u",
-            stats[i].instance_count);
+static
+const ecs_vector_params_t table_stat_params = {
+    .element_size = sizeof(admin_table_stat_t)
+};
 
-        ecs_strbuf_list_pop(reply, "}");
+/* Size of a single row in a table, which includes the entity id */
+static
+uint32_t table_row_size(
+    ecs_world_t *world,
+    ecs_type_t type)
+{
+    ecs_entity_t *components = ecs_vector_first(type);
+    uint32_t i, count = ecs_vector_count(type);
+    uint32_t result = sizeof(ecs_entity_t);
+
+    for (i = 0; i < count; i ++) {
+        EcsComponent *component = ecs_get_ptr(world, components[i], EcsComponent);
+        if (component) {
+            result += component->size;
+        }
+    }
+
+    return result;
+}
+
+/* Column of a table as it is stored by flecs (ecs_table_column_t). Table
+ * columns are not part of the public API, but are passed to systems as
+ * rows->table_columns. The first column stores the entity ids, followed by one
+ * column per component in the table type. */
+typedef struct admin_table_column_t {
+    ecs_vector_t *data;
+    uint16_t size;
+} admin_table_column_t;
+
+/* The signature of this system only contains a tag that is never added to an
+ * entity, which causes it to match every non-empty table in the world. */
+static
+void AdminHttpReplyTableStats(ecs_rows_t *rows) {
+    admin_table_totals_t *totals = rows->param;
+    ecs_type_t type = ecs_table_type(rows);
+    admin_table_column_t *columns = rows->table_columns;
+
+    admin_table_stat_t *stat = ecs_vector_add(
+        &totals->tables, &table_stat_params);
+    stat->type = type;
+    stat->row_count = rows->count;
+    stat->row_size = table_row_size(rows->world, type);
+    stat->capacity = ecs_vector_size(columns[0].data);
+    stat->memory_allocd = 
+        (uint64_t)stat->capacity * sizeof(ecs_entity_t);
+
+    uint32_t i, count = ecs_vector_count(type);
+    for (i = 1; i <= count; i ++) {
+        if (columns[i].size) {
+            stat->memory_allocd += 
+                (uint64_t)ecs_vector_size(columns[i].data) * columns[i].size;
+        }
+    }
+}
+
+static
+void AdminHttpReplyTableTotals(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsWorldStats, stats, 1);
+    ECS_COLUMN(rows, EcsMemoryStats, memory, 2);
+
+    admin_table_totals_t *totals = rows->param;
+    totals->table_count = stats->tables_count;
+    totals->memory_used = memory->tables_memory.used_bytes;
+    totals->memory_allocd = memory->tables_memory.allocd_bytes;
+}
+
+static
+void write_table(
+    ecs_world_t *world,
+    ecs_strbuf_t *reply,
+    admin_table_stat_t *stat)
+{
+    char *columns = ecs_type_to_expr(world, stat->type);
+
+    ecs_strbuf_list_next(reply);
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    ecs_strbuf_list_append(reply, "\"columns\":\"%s\"",
+        columns ? columns : "");
+
+    ecs_strbuf_list_append(reply, "\"component_count\":%u",
+        ecs_vector_count(stat->type));
+
+    ecs_strbuf_list_append(reply, "\"row_count\":%u",
+        stat->row_count);
+
+    ecs_strbuf_list_append(reply, "\"capacity\":%u",
+        stat->capacity);
+
+    ecs_strbuf_list_append(reply, "\"row_size\":%u",
+        stat->row_size);
+
+    ecs_strbuf_list_append(reply, "\"memory_used\":%llu",
+        (unsigned long long)stat->row_count * stat->row_size);
+
+    ecs_strbuf_list_append(reply, "\"memory_allocd\":%llu",
+        (unsigned long long)stat->memory_allocd);
+
+    ecs_strbuf_list_pop(reply, "}");
+
+    ecs_os_free(columns);
+}
+
+static
+void AdminHttpReplyTables(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyTableStats, 1);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyTableTotals, 2);
+
+    ecs_world_t *world = rows->world;
+    admin_reply_t *params = rows->param;
+    ecs_strbuf_t *reply = params->buf;
+
+    admin_table_totals_t totals = {
+        .tables = ecs_vector_new(&table_stat_params, 0)
+    };
+
+    ecs_run(world, AdminHttpReplyTableStats, 0, &totals);
+    ecs_run(world, AdminHttpReplyTableTotals, 0, &totals);
+
+    admin_table_stat_t *stats = ecs_vector_first(totals.tables);
+    uint32_t i, count = ecs_vector_count(totals.tables);
+    uint64_t row_count = 0;
+
+    /* Tables that are not visited by AdminHttpReplyTableStats are empty */
+    uint32_t table_count = totals.table_count > count 
+        ? totals.table_count 
+        : count
+        ;
+    uint32_t empty_count = table_count - count;
+    uint32_t small_count = empty_count;
+
+    admin_select_t select;
+    admin_select_init(&select, &params->tables);
+
+    for (i = 0; i < count; i ++) {
+        admin_table_stat_t *stat = &stats[i];
+        uint64_t table_used = (uint64_t)stat->row_count * stat->row_size;
+        double key;
+
+        switch(select.page.sort) {
+        case AdminSortWaste:
+            key = stat->memory_allocd > table_used 
+                ? (double)(stat->memory_allocd - table_used) 
+                : 0
+                ;
+            break;
+        case AdminSortEntities:
+            key = stat->row_count;
+            break;
+        case AdminSortComponents:
+            key = ecs_vector_count(stat->type);
+            break;
+        default:
+            key = table_used;
+            break;
+        }
+
+        admin_select_add(&select, key, i, stat, NULL);
+
+        if (stat->row_count <= params->small_table_rows) {
+            small_count ++;
+        }
+
+        row_count += stat->row_count;
+    }
+
+    ecs_strbuf_list_push(reply, "{", ",");
+
+    /* World-wide fragmentation indicators */
+    ecs_strbuf_list_append(reply, "\"table_count\":%u", table_count);
+    ecs_strbuf_list_append(reply, "\"empty_table_count\":%u", empty_count);
+    ecs_strbuf_list_append(reply, "\"small_table_count\":%u", small_count);
+    ecs_strbuf_list_append(reply, "\"small_table_rows\":%u", 
+        params->small_table_rows);
+    ecs_strbuf_list_append(reply, "\"avg_rows\":%f", 
+        table_count ? (double)row_count / table_count : 0);
+    ecs_strbuf_list_append(reply, "\"memory_used\":%llu", 
+        (unsigned long long)totals.memory_used);
+    ecs_strbuf_list_append(reply, "\"memory_allocd\":%llu", 
+        (unsigned long long)totals.memory_allocd);
+
+    uint32_t page_count;
+    admin_select_elem_t *elems = admin_select_page(&select, &page_count);
+
+    ecs_strbuf_list_appendstr(reply, "\"tables\":");
+    ecs_strbuf_list_push(reply, "[", ",");
+    for (i = 0; i < page_count; i ++) {
+        write_table(world, reply, elems[i].stats);
     }
+    ecs_strbuf_list_pop(reply, "]");
+
+    write_cursor(reply, &params->tables, count);
+
+    ecs_strbuf_list_pop(reply, "}");
+
+    admin_select_deinit(&select);
+    ecs_vector_free(totals.tables);
+}
+
+static
+void AdminHttpReplyWorldSummary(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsWorldStats, stats, 1);
+    ECS_COLUMN(rows, AdminWorldStats, admin_stats, 2);
+
+    ecs_strbuf_t *reply = rows->param;
+
+    ecs_strbuf_list_append(reply, "\"system_count\":%d", 
+        stats->col_systems_count + stats->row_systems_count);
+    ecs_strbuf_list_append(reply, "\"entity_count\":%d", 
+        stats->entities_count);
+    ecs_strbuf_list_append(reply, "\"table_count\":%d", 
+        stats->tables_count);
+    ecs_strbuf_list_append(reply, "\"fps\":%f", admin_stats->fps.current);
+    ecs_strbuf_list_append(reply, "\"frame\":%f", admin_stats->frame.current);
+}
+
+static
+void AdminHttpReplyMemorySummary(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, AdminMemoryStats, admin_stats, 1);
+
+    ecs_strbuf_t *reply = rows->param;
+
+    ecs_strbuf_list_append(reply, "\"memory_used\":%f", 
+        admin_stats->total.used.current);
+    ecs_strbuf_list_append(reply, "\"memory_allocd\":%f", 
+        admin_stats->total.allocd.current);
+}
+
+static
+void AdminHttpReplySummary(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyWorldSummary, 1);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyMemorySummary, 2);
+
+    ecs_world_t *world = rows->world;
+    ecs_strbuf_t *reply = rows->param;
+
+    ecs_run(world, AdminHttpReplyWorldSummary, 0, reply);
+    ecs_run(world, AdminHttpReplyMemorySummary, 0, reply);
 }
 
 static
@@ -348,31 +935,40 @@ void AdminHttpReply(ecs_rows_t *rows) {
     ECS_COLUMN_ENTITY(rows, AdminHttpReplySystemStats, 3);
     ECS_COLUMN_ENTITY(rows, AdminHttpReplyComponentStats, 4);
     ECS_COLUMN_ENTITY(rows, AdminHttpReplyTypeStats, 5);
+    ECS_COLUMN_ENTITY(rows, AdminHttpReplyMetricStats, 6);
+    ECS_COLUMN_ENTITY(rows, AdminHttpRequestComponentHistory, 7);
     
     ecs_world_t *world = rows->world;
-    ecs_strbuf_t *reply = rows->param;
+    admin_reply_t *params = rows->param;
+    ecs_strbuf_t *reply = params->buf;
+
+    if (params->history) {
+        ecs_run(world, AdminHttpRequestComponentHistory, 0, &params->history);
+    }
 
     ecs_strbuf_list_push(reply, "{", ",");
     ecs_run(world, AdminHttpReplyWorldStats, 0, reply);
 
     ecs_strbuf_list_appendstr(reply, "\"memory\":");
     ecs_strbuf_list_push(reply, "{", ",");
-    ecs_run(world, AdminHttpReplyMemoryStats, 0, reply);
+    ecs_run(world, AdminHttpReplyMemoryStats, 0, params);
     ecs_strbuf_list_pop(reply, "}");
 
     ecs_strbuf_list_appendstr(reply, "\"systems\":");
     ecs_strbuf_list_push(reply, "{", ",");    
-    ecs_run(world, AdminHttpReplySystemStats, 0, reply);
+    ecs_run(world, AdminHttpReplySystemStats, 0, params);
     ecs_strbuf_list_pop(reply, "}");
 
     ecs_strbuf_list_appendstr(reply, "\"components\":");
-    ecs_strbuf_list_push(reply, "[", ",");
-    ecs_run(world, AdminHttpReplyComponentStats, 0, reply);
-    ecs_strbuf_list_pop(reply, "]");
+    write_page(world, AdminHttpReplyComponentStats, &params->components, 
+        true, reply);
 
     ecs_strbuf_list_appendstr(reply, "\"types\":");
+    write_page(world, AdminHttpReplyTypeStats, &params->types, false, reply);
+
+    ecs_strbuf_list_appendstr(reply, "\"metrics\":");
     ecs_strbuf_list_push(reply, "[", ",");
-    ecs_run(world, AdminHttpReplyTypeStats, 0, reply);
+    ecs_run(world, AdminHttpReplyMetricStats, 0, reply);
     ecs_strbuf_list_pop(reply, "]");
 
     ecs_strbuf_list_pop(reply, "}");
@@ -392,6 +988,10 @@ void AdminHttpImport(
     ECS_SYSTEM(world, AdminHttpReplyMemoryStats, EcsManual, [in] AdminMemoryStats,
         SYSTEM.EcsHidden);
 
+    /* Write application-defined metrics to the reply */
+    ECS_SYSTEM(world, AdminHttpReplyMetricStats, EcsManual, [in] EcsAdminMetric, [in] AdminMetricStats,
+        SYSTEM.EcsHidden);
+
     /* Write system statistics per phase. The admin JSON format organizes systems per phase. Each of
      * these systems iterates over all the system statistics, but only writes the ones to JSON that
      * match its own phase. */
@@ -427,14 +1027,49 @@ void AdminHttpImport(
         .AdminHttpReplySystemManual,
         SYSTEM.EcsHidden);
 
-    /* Write component statistics to the reply */
+    /* Collect component statistics for a page in the reply */
     ECS_SYSTEM(world, AdminHttpReplyComponentStats, EcsManual, [in] EcsComponentStats, [in] AdminComponentStats,
         SYSTEM.EcsHidden);
 
-    /* Write type statistics to the reply */
+    /* Collect type statistics for a page in the reply */
     ECS_SYSTEM(world, AdminHttpReplyTypeStats, EcsManual, [in] EcsTypeStats,
         SYSTEM.EcsHidden);
 
+    /* Request history for the component passed as param */
+    ECS_SYSTEM(world, AdminHttpRequestComponentHistory, EcsManual, 
+        [in] EcsComponentStats, [out] AdminComponentStats,
+        SYSTEM.EcsHidden);
+
+    /* Write a page of components or types to the reply. These systems can be
+     * invoked directly, so clients can request lists without the rest of the
+     * world statistics. */
+    ECS_SYSTEM(world, AdminHttpReplyComponents, EcsManual,
+        .AdminHttpReplyComponentStats,
+        .AdminHttpRequestComponentHistory,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminHttpReplyTypes, EcsManual,
+        .AdminHttpReplyTypeStats,
+        SYSTEM.EcsHidden);
+
+    /* Collect table statistics. AdminTableProbe is never added to an entity,
+     * so the system matches all tables. */
+    ECS_TAG(world, AdminTableProbe);
+    ECS_SYSTEM(world, AdminHttpReplyTableStats, EcsManual, !AdminTableProbe,
+        SYSTEM.EcsHidden);
+
+    /* Number of tables and table memory, which include empty tables */
+    ECS_SYSTEM(world, AdminHttpReplyTableTotals, EcsManual, 
+        [in] EcsWorldStats, [in] EcsMemoryStats,
+        SYSTEM.EcsHidden);
+
+    /* Write a page of table statistics to the reply. Table statistics are
+     * expensive to collect, so they are not part of the main reply. */
+    ECS_SYSTEM(world, AdminHttpReplyTables, EcsManual,
+        .AdminHttpReplyTableStats,
+        .AdminHttpReplyTableTotals,
+        SYSTEM.EcsHidden);
+
     /* The main system that invokes all other systems */
     ECS_SYSTEM(world, AdminHttpReply, EcsManual,
         .AdminHttpReplyWorldStats,
@@ -442,6 +1077,20 @@ void AdminHttpImport(
         .AdminHttpReplySystemStats,
         .AdminHttpReplyComponentStats,
         .AdminHttpReplyTypeStats,
+        .AdminHttpReplyMetricStats,
+        .AdminHttpRequestComponentHistory,
+        SYSTEM.EcsHidden);
+
+    /* Write summary of the world, used when an admin serves multiple worlds */
+    ECS_SYSTEM(world, AdminHttpReplyWorldSummary, EcsManual, [in] EcsWorldStats, [in] AdminWorldStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminHttpReplyMemorySummary, EcsManual, [in] AdminMemoryStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminHttpReplySummary, EcsManual,
+        .AdminHttpReplyWorldSummary,
+        .AdminHttpReplyMemorySummary,
         SYSTEM.EcsHidden);
 
     /* Feature that contains all system statistics systems */
@@ -460,15 +1109,27 @@ void AdminHttpImport(
     ECS_TYPE(world, AdminHttpSystems,
         AdminHttpReplyWorldStats,
         AdminHttpReplyMemoryStats,
+        AdminHttpReplyMetricStats,
         AdminHttpReplySystemSystems,
         AdminHttpReplySystemStats,
         AdminHttpReplyComponentStats,
-        AdminHttpReplyTypeStats);
+        AdminHttpReplyTypeStats,
+        AdminHttpReplyComponents,
+        AdminHttpReplyTypes,
+        AdminHttpReplyTableStats,
+        AdminHttpReplyTables,
+        AdminHttpReplyWorldSummary,
+        AdminHttpReplyMemorySummary,
+        AdminHttpReplySummary);
 
     /* Make features hidden, as they expose module internals */
     ecs_add(world, AdminHttpReplySystemSystems, EcsHidden);
     ecs_add(world, AdminHttpSystems, EcsHidden);
 
     ECS_EXPORT_ENTITY(AdminHttpReply);
+    ECS_EXPORT_ENTITY(AdminHttpReplyComponents);
+    ECS_EXPORT_ENTITY(AdminHttpReplyTypes);
+    ECS_EXPORT_ENTITY(AdminHttpReplyTables);
+    ECS_EXPORT_ENTITY(AdminHttpReplySummary);
     ECS_EXPORT_ENTITY(AdminHttpSystems);
 }
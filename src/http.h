@@ -1,11 +1,33 @@
 #include <flecs_systems_admin.h>
+#include "util.h"
 
 /* The AdminHttp module contains only manual systems that create an JSON reply
  * body by walking over entities with statistics information. To create a reply,
  * an application should invoke the AdminHttpReply system. */
 
+/* Parameter passed to the AdminHttpReply* systems */
+typedef struct admin_reply_t {
+    ecs_strbuf_t *buf;
+    admin_page_t components;
+    admin_page_t types;
+    admin_page_t tables;
+
+    /* Tables with this number of rows or less count as small tables */
+    uint32_t small_table_rows;
+
+    /* Memory limit of the admin, 0 if not set */
+    uint64_t memory_limit;
+
+    /* System of which the client requests history, 0 if not set */
+    ecs_entity_t history;
+} admin_reply_t;
+
 typedef struct AdminHttp {
     ECS_DECLARE_ENTITY(AdminHttpReply);
+    ECS_DECLARE_ENTITY(AdminHttpReplyComponents);
+    ECS_DECLARE_ENTITY(AdminHttpReplyTypes);
+    ECS_DECLARE_ENTITY(AdminHttpReplyTables);
+    ECS_DECLARE_ENTITY(AdminHttpReplySummary);
     ECS_DECLARE_ENTITY(AdminHttpSystems);
 } AdminHttp;
 
@@ -15,5 +37,9 @@ void AdminHttpImport(
 
 #define AdminHttpImportHandles(handles) \
     ECS_IMPORT_ENTITY(handles, AdminHttpReply);\
+    ECS_IMPORT_ENTITY(handles, AdminHttpReplyComponents);\
+    ECS_IMPORT_ENTITY(handles, AdminHttpReplyTypes);\
+    ECS_IMPORT_ENTITY(handles, AdminHttpReplyTables);\
+    ECS_IMPORT_ENTITY(handles, AdminHttpReplySummary);\
     ECS_IMPORT_ENTITY(handles, AdminHttpSystems)
 
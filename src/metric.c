@@ -0,0 +1,67 @@
+#include <flecs_systems_admin.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+/* Gauges store the bits of a double in the metric value, so that gauges and
+ * counters can be read and written with the same 64 bit atomic operations. */
+
+static
+void metric_store(
+    ecs_admin_metric_t *metric,
+    int64_t value)
+{
+#ifdef _MSC_VER
+    InterlockedExchange64(&metric->value, value);
+#else
+    __atomic_store_n(&metric->value, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static
+int64_t metric_load(
+    ecs_admin_metric_t *metric)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange64(&metric->value, 0, 0);
+#else
+    return __atomic_load_n(&metric->value, __ATOMIC_RELAXED);
+#endif
+}
+
+void ecs_admin_gauge_set(
+    ecs_admin_metric_t *metric,
+    double value)
+{
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    metric_store(metric, bits);
+}
+
+void ecs_admin_counter_add(
+    ecs_admin_metric_t *metric,
+    int64_t value)
+{
+#ifdef _MSC_VER
+    InterlockedExchangeAdd64(&metric->value, value);
+#else
+    __atomic_fetch_add(&metric->value, value, __ATOMIC_RELAXED);
+#endif
+}
+
+double ecs_admin_metric_get(
+    ecs_admin_metric_t *metric,
+    EcsAdminMetricKind kind)
+{
+    int64_t bits = metric_load(metric);
+
+    if (kind == EcsAdminGauge) {
+        double value;
+        memcpy(&value, &bits, sizeof(double));
+        return value;
+    } else {
+        return bits;
+    }
+}
@@ -0,0 +1,501 @@
+/* Required for dladdr */
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <flecs_systems_admin.h>
+#include "profile.h"
+#include "server.h"
+#include <string.h>
+
+/* Callback and name of a system */
+typedef struct admin_profile_system_t {
+    void *action;
+    char *name;
+} admin_profile_system_t;
+
+static
+const ecs_vector_params_t profile_system_params = {
+    .element_size = sizeof(admin_profile_system_t)
+};
+
+/* Systems are stored in the EcsColSystem component, which is not part of the
+ * public API. Its first member is the system callback, which is all that is
+ * read from it. */
+static
+void AdminProfileSystems(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsSystemStats, stats, 1);
+
+    ecs_world_t *world = rows->world;
+    ecs_vector_t **systems = rows->param;
+
+    ecs_entity_t col_system = ecs_lookup(world, "EcsColSystem");
+    if (!col_system) {
+        return;
+    }
+
+    ecs_type_t col_system_type = ecs_type_from_entity(world, col_system);
+
+    int32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_system_action_t *action = _ecs_get_ptr(
+            world, stats[i].entity, col_system_type);
+        if (!action || !*action || !stats[i].name) {
+            continue;
+        }
+
+        size_t len = strlen(stats[i].name) + 1;
+        admin_profile_system_t *system = ecs_vector_add(
+            systems, &profile_system_params);
+        system->action = (void*)*action;
+        system->name = ecs_os_malloc(len);
+        memcpy(system->name, stats[i].name, len);
+    }
+}
+
+#ifdef __linux__
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+typedef struct admin_profile_sample_t {
+    int32_t weight;
+    int32_t count;
+    void *system;       /* Action of innermost system on the stack, or NULL */
+    void *frames[ADMIN_PROFILE_DEPTH];
+} admin_profile_sample_t;
+
+/* Number of frames that belong to the signal handler and the signal trampoline,
+ * which are not part of the sampled stack. */
+#define PROFILE_SKIP_FRAMES (2)
+
+/* Samples are written by the signal handler, which may run on any thread. Slots
+ * are claimed with an atomic increment, so the handler does not lock. */
+static admin_profile_sample_t *samples;
+static volatile int32_t sample_count;
+static int32_t sample_max;
+static volatile int32_t profile_running;
+
+static pthread_once_t backtrace_once = PTHREAD_ONCE_INIT;
+
+/* backtrace is not async-signal-safe. Its first call loads libgcc, which
+ * allocates and takes the loader lock, so it is called once before a handler is
+ * installed. After that, glibc unwinds without allocating, which is what the
+ * handler relies on. A signal that interrupts the loader (dlopen) while a
+ * profile runs can still deadlock, so profiles should not be taken while the
+ * application loads libraries. */
+static
+void backtrace_prime(void)
+{
+    void *frame[1];
+    backtrace(frame, 1);
+}
+
+static
+void profile_handler(
+    int sig,
+    siginfo_t *info,
+    void *uctx)
+{
+    int saved_errno = errno;
+
+    int32_t index = __atomic_fetch_add(&sample_count, 1, __ATOMIC_RELAXED);
+    if (index < sample_max) {
+        admin_profile_sample_t *sample = &samples[index];
+        sample->weight = 1;
+        sample->system = NULL;
+        sample->count = backtrace(sample->frames, ADMIN_PROFILE_DEPTH);
+    }
+
+    errno = saved_errno;
+}
+
+/* Order samples by their frames, so that identical stacks are adjacent */
+static
+int compare_samples(
+    const void *p1,
+    const void *p2)
+{
+    const admin_profile_sample_t *s1 = p1;
+    const admin_profile_sample_t *s2 = p2;
+
+    if (s1->system != s2->system) {
+        return s1->system < s2->system ? -1 : 1;
+    }
+
+    if (s1->count != s2->count) {
+        return s1->count - s2->count;
+    }
+
+    int32_t i;
+    for (i = 0; i < s1->count; i ++) {
+        if (s1->frames[i] != s2->frames[i]) {
+            return s1->frames[i] < s2->frames[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Sort samples and merge identical stacks. Returns the number of unique
+ * stacks, which are stored at the start of the array. */
+static
+int32_t merge_samples(
+    admin_profile_sample_t *samples,
+    int32_t count)
+{
+    qsort(samples, count, sizeof(admin_profile_sample_t), compare_samples);
+
+    int32_t i, unique = 0;
+    for (i = 0; i < count; i ++) {
+        if (unique && !compare_samples(&samples[unique - 1], &samples[i])) {
+            samples[unique - 1].weight += samples[i].weight;
+        } else {
+            samples[unique ++] = samples[i];
+        }
+    }
+
+    return unique;
+}
+
+static
+int compare_systems(
+    const void *p1,
+    const void *p2)
+{
+    const admin_profile_system_t *s1 = p1;
+    const admin_profile_system_t *s2 = p2;
+
+    if (s1->action == s2->action) {
+        return 0;
+    }
+
+    return s1->action < s2->action ? -1 : 1;
+}
+
+/* Find the system that a frame belongs to. System callbacks are usually static
+ * and not in the dynamic symbol table, so the system is the callback with the
+ * highest address at or below the frame. A frame only belongs to that system
+ * if no exported function starts in between. */
+static
+admin_profile_system_t* find_system(
+    ecs_vector_t *systems,
+    void *frame)
+{
+    admin_profile_system_t *buffer = ecs_vector_first(systems);
+    int32_t lo = 0, hi = ecs_vector_count(systems);
+
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+        if (buffer[mid].action <= frame) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (!lo) {
+        return NULL;
+    }
+
+    admin_profile_system_t *system = &buffer[lo - 1];
+
+    Dl_info info;
+    if (dladdr(frame, &info) && info.dli_saddr && 
+        (char*)info.dli_saddr > (char*)system->action) 
+    {
+        return NULL;
+    }
+
+    return system;
+}
+
+/* Replace the addresses in a stack with the start addresses of the functions
+ * they belong to, so that samples taken at different instructions of the same
+ * function are merged. The innermost system on the stack is stored with the
+ * sample. */
+static
+void normalize_sample(
+    admin_profile_sample_t *sample,
+    ecs_vector_t *systems)
+{
+    int32_t i;
+    for (i = sample->count - 1; i >= PROFILE_SKIP_FRAMES; i --) {
+        admin_profile_system_t *system = find_system(
+            systems, sample->frames[i]);
+
+        if (system) {
+            sample->frames[i] = system->action;
+            sample->system = system->action;
+        } else {
+            Dl_info info;
+            if (dladdr(sample->frames[i], &info) && info.dli_saddr) {
+                sample->frames[i] = info.dli_saddr;
+            }
+        }
+    }
+}
+
+/* Get name for frame. Systems are named after the system entity, other
+ * functions are only found if they are exported, so applications should link
+ * with -rdynamic for readable stacks. */
+static
+const char* frame_name(
+    ecs_vector_t *systems,
+    void *frame,
+    char *buf,
+    size_t size)
+{
+    admin_profile_system_t key = {.action = frame};
+    admin_profile_system_t *system = bsearch(&key, 
+        ecs_vector_first(systems), ecs_vector_count(systems),
+        sizeof(admin_profile_system_t), compare_systems);
+    if (system) {
+        return system->name;
+    }
+
+    Dl_info info;
+    if (dladdr(frame, &info) && info.dli_sname) {
+        return info.dli_sname;
+    }
+
+    snprintf(buf, size, "%p", frame);
+    return buf;
+}
+
+/* Write stack root first, prefixed with the running system */
+static
+void write_stack(
+    ecs_vector_t *systems,
+    admin_profile_sample_t *sample,
+    ecs_strbuf_t *buf)
+{
+    char addr[32];
+
+    if (sample->system) {
+        ecs_strbuf_append(buf, "[%s]", 
+            frame_name(systems, sample->system, addr, sizeof(addr)));
+    } else {
+        ecs_strbuf_appendstr(buf, "[no system]");
+    }
+
+    int32_t i;
+    for (i = sample->count - 1; i >= PROFILE_SKIP_FRAMES; i --) {
+        ecs_strbuf_append(buf, ";%s",
+            frame_name(systems, sample->frames[i], addr, sizeof(addr)));
+    }
+
+    ecs_strbuf_append(buf, " %d\n", sample->weight);
+}
+
+/* Request for the callbacks of the systems of a world */
+typedef struct profile_systems_request_t {
+    ecs_entity_t profile_systems;
+    ecs_vector_t *systems;
+} profile_systems_request_t;
+
+static
+bool run_capture_systems(
+    admin_world_t *world,
+    void *ctx)
+{
+    profile_systems_request_t *r = ctx;
+    ecs_run(world->world, r->profile_systems, 0, &r->systems);
+    return true;
+}
+
+/* Capture the callbacks of the systems of the world. The world runs on another
+ * thread, so its systems are visited on the thread of the world. */
+static
+ecs_vector_t* capture_systems(
+    ecs_world_t *world,
+    ecs_entity_t profile_systems)
+{
+    profile_systems_request_t r = {
+        .profile_systems = profile_systems,
+        .systems = ecs_vector_new(&profile_system_params, 0)
+    };
+
+    admin_server_run_world(world, run_capture_systems, &r);
+    ecs_vector_t *systems = r.systems;
+
+    qsort(ecs_vector_first(systems), ecs_vector_count(systems), 
+        sizeof(admin_profile_system_t), compare_systems);
+
+    return systems;
+}
+
+static
+void free_systems(
+    ecs_vector_t *systems)
+{
+    admin_profile_system_t *buffer = ecs_vector_first(systems);
+    uint32_t i, count = ecs_vector_count(systems);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(buffer[i].name);
+    }
+
+    ecs_vector_free(systems);
+}
+
+static
+void profile_sleep(
+    uint32_t duration)
+{
+    struct timespec remaining = {.tv_sec = duration};
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR) { }
+}
+
+bool admin_profile_supported(void)
+{
+    return true;
+}
+
+bool admin_profile_run(
+    ecs_world_t *world,
+    ecs_entity_t profile_systems,
+    uint32_t rate,
+    uint32_t duration,
+    ecs_strbuf_t *buf,
+    uint32_t *dropped_out)
+{
+    if (__atomic_exchange_n(&profile_running, 1, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    if (rate < ADMIN_PROFILE_MIN_RATE) {
+        rate = ADMIN_PROFILE_MIN_RATE;
+    } else if (rate > ADMIN_PROFILE_MAX_RATE) {
+        rate = ADMIN_PROFILE_MAX_RATE;
+    }
+
+    if (!duration) {
+        duration = ADMIN_PROFILE_DEFAULT_DURATION;
+    } else if (duration > ADMIN_PROFILE_MAX_DURATION) {
+        duration = ADMIN_PROFILE_MAX_DURATION;
+    }
+
+    /* Allocate for the number of samples expected at this rate. The timer
+     * measures CPU time of all threads, so a process that keeps more than one
+     * core busy produces more samples, which are dropped when the buffer is
+     * full. */
+    sample_max = rate * duration * 2;
+    if (sample_max > ADMIN_PROFILE_MAX_SAMPLES) {
+        sample_max = ADMIN_PROFILE_MAX_SAMPLES;
+    }
+
+    samples = ecs_os_malloc(sample_max * sizeof(admin_profile_sample_t));
+    if (!samples) {
+        __atomic_store_n(&profile_running, 0, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    __atomic_store_n(&sample_count, 0, __ATOMIC_RELAXED);
+
+    pthread_once(&backtrace_once, backtrace_prime);
+
+    struct sigaction action = {0}, prev_action;
+    action.sa_sigaction = profile_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &prev_action);
+
+    long interval = 1000000 / rate;
+    struct itimerval timer = {
+        .it_interval = {.tv_sec = interval / 1000000, .tv_usec = interval % 1000000},
+        .it_value = {.tv_sec = interval / 1000000, .tv_usec = interval % 1000000}
+    };
+    struct itimerval prev_timer;
+    setitimer(ITIMER_PROF, &timer, &prev_timer);
+
+    ecs_os_dbg("admin: profiling for %us at %uHz", duration, rate);
+
+    profile_sleep(duration);
+
+    struct itimerval stop = {{0}};
+    setitimer(ITIMER_PROF, &stop, NULL);
+
+    /* A handler may still be running on another thread after the timer has
+     * been stopped. Restore the previous handler after a short grace period
+     * before reading the samples. */
+    struct timespec grace = {.tv_nsec = 10 * 1000 * 1000};
+    nanosleep(&grace, NULL);
+    sigaction(SIGPROF, &prev_action, NULL);
+    setitimer(ITIMER_PROF, &prev_timer, NULL);
+
+    int32_t count = __atomic_load_n(&sample_count, __ATOMIC_ACQUIRE);
+    if (count > sample_max) {
+        *dropped_out = count - sample_max;
+        count = sample_max;
+    } else {
+        *dropped_out = 0;
+    }
+
+    /* Merge identical stacks before symbolizing, so that only unique stacks
+     * are resolved, then merge again as stacks with different addresses can
+     * resolve to the same functions. */
+    count = merge_samples(samples, count);
+
+    ecs_vector_t *systems = capture_systems(world, profile_systems);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        normalize_sample(&samples[i], systems);
+    }
+
+    count = merge_samples(samples, count);
+
+    for (i = 0; i < count; i ++) {
+        write_stack(systems, &samples[i], buf);
+    }
+
+    free_systems(systems);
+    ecs_os_free(samples);
+    samples = NULL;
+
+    __atomic_store_n(&profile_running, 0, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+#else
+
+bool admin_profile_supported(void)
+{
+    return false;
+}
+
+bool admin_profile_run(
+    ecs_world_t *world,
+    ecs_entity_t profile_systems,
+    uint32_t rate,
+    uint32_t duration,
+    ecs_strbuf_t *buf,
+    uint32_t *dropped_out)
+{
+    return false;
+}
+
+#endif
+
+void AdminProfileImport(
+    ecs_world_t *world,
+    int flags)
+{
+    ECS_MODULE(world, AdminProfile);
+
+    /* Collect the callbacks of systems, which the profiler uses to find the
+     * systems on a stack */
+    ECS_SYSTEM(world, AdminProfileSystems, EcsManual, [in] EcsSystemStats,
+        SYSTEM.EcsHidden);
+
+    ECS_EXPORT_ENTITY(AdminProfileSystems);
+}
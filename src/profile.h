@@ -0,0 +1,52 @@
+#include <flecs_systems_admin.h>
+
+/* The sampling profiler periodically interrupts the process with SIGPROF, and
+ * records the stack of the thread that was running. Samples are aggregated into
+ * collapsed stacks ("frame;frame;frame count"), which is the input format of
+ * most flame graph tools. The profiler is only available on Linux. */
+
+/* Maximum number of frames recorded per sample */
+#define ADMIN_PROFILE_DEPTH (48)
+
+/* Maximum number of samples recorded per profile. Samples beyond this number
+ * are dropped, which bounds the memory used by a profile. */
+#define ADMIN_PROFILE_MAX_SAMPLES (32768)
+
+/* Bounds for the sample rate, in samples per second of CPU time */
+#define ADMIN_PROFILE_MIN_RATE (1)
+#define ADMIN_PROFILE_MAX_RATE (1000)
+#define ADMIN_PROFILE_DEFAULT_RATE (99)
+
+/* Bounds for the duration of a profile, in seconds */
+#define ADMIN_PROFILE_MAX_DURATION (60)
+#define ADMIN_PROFILE_DEFAULT_DURATION (5)
+
+/* Returns true if profiling is supported on this platform */
+bool admin_profile_supported(void);
+
+/* Sample the process for the specified duration, and append collapsed stacks
+ * to buf. Each stack is prefixed with the system that was running, if the
+ * system could be found on the stack. Systems are found by the addresses of
+ * their callbacks, which are collected with the AdminProfileSystems system
+ * on the thread of the world. This function blocks for the duration of the
+ * profile, and must not be called from the thread that runs the world.
+ * Returns false if profiling is not supported or if another profile is already
+ * running. */
+bool admin_profile_run(
+    ecs_world_t *world,
+    ecs_entity_t profile_systems,
+    uint32_t rate,
+    uint32_t duration,
+    ecs_strbuf_t *buf,
+    uint32_t *dropped_out);
+
+typedef struct AdminProfile {
+    ECS_DECLARE_ENTITY(AdminProfileSystems);
+} AdminProfile;
+
+void AdminProfileImport(
+    ecs_world_t *world,
+    int flags);
+
+#define AdminProfileImportHandles(handles) \
+    ECS_IMPORT_ENTITY(handles, AdminProfileSystems);
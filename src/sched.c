@@ -0,0 +1,247 @@
+#include <flecs_systems_admin.h>
+#include "sched.h"
+#include <string.h>
+#include <stdio.h>
+
+/* Reply of a request that is being serialized. Requests with the same key
+ * join the flight, and get the reply when the flight lands. The reply is
+ * shared by all requests that joined, and is freed by the last of them. */
+typedef struct sched_flight_t {
+    char *key;
+    bool done;
+    bool result;
+    int status;
+    char *header;
+    char *body;
+    uint32_t refs;          /* Requests that hold on to the flight */
+} sched_flight_t;
+
+struct admin_sched_t {
+    ecs_os_mutex_t lock;
+    ecs_os_cond_t cond;     /* Signalled when a flight lands or a slot frees */
+    ecs_vector_t *flights;  /* In-flight requests (sched_flight_t*) */
+    uint32_t running;
+    uint32_t waiting;
+    ecs_admin_metric_t shed;
+    ecs_admin_metric_t coalesced;
+};
+
+static
+const ecs_vector_params_t ptr_params = {
+    .element_size = sizeof(void*)
+};
+
+static
+char* sched_strdup(
+    const char *str)
+{
+    if (!str) {
+        return NULL;
+    }
+
+    size_t len = strlen(str) + 1;
+    char *result = ecs_os_malloc(len);
+    memcpy(result, str, len);
+    return result;
+}
+
+static
+sched_flight_t* find_flight(
+    admin_sched_t *sched,
+    const char *key)
+{
+    sched_flight_t **buffer = ecs_vector_first(sched->flights);
+    uint32_t i, count = ecs_vector_count(sched->flights);
+
+    for (i = 0; i < count; i ++) {
+        if (!strcmp(buffer[i]->key, key)) {
+            return buffer[i];
+        }
+    }
+
+    return NULL;
+}
+
+static
+void remove_flight(
+    admin_sched_t *sched,
+    sched_flight_t *flight)
+{
+    sched_flight_t **buffer = ecs_vector_first(sched->flights);
+    uint32_t i, count = ecs_vector_count(sched->flights);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == flight) {
+            ecs_vector_remove_index(sched->flights, &ptr_params, i);
+            break;
+        }
+    }
+}
+
+static
+void free_flight(
+    sched_flight_t *flight)
+{
+    ecs_os_free(flight->key);
+    ecs_os_free(flight->header);
+    ecs_os_free(flight->body);
+    ecs_os_free(flight);
+}
+
+/* Release a reference to a flight. Must be called with the lock. Returns the
+ * flight if it should be freed, which is done after releasing the lock. */
+static
+sched_flight_t* release_flight(
+    sched_flight_t *flight)
+{
+    if (!-- flight->refs) {
+        return flight;
+    }
+
+    return NULL;
+}
+
+/* Wait for the reply of an in-flight request. Must be called with the lock,
+ * and unlocks it. The reply of the flight does not change once it has landed,
+ * so it is copied into the reply of this request without the lock. */
+static
+bool join_flight(
+    admin_sched_t *sched,
+    sched_flight_t *flight,
+    EcsHttpReply *reply)
+{
+    flight->refs ++;
+
+    while (!flight->done) {
+        ecs_os_cond_wait(sched->cond, sched->lock);
+    }
+
+    ecs_os_mutex_unlock(sched->lock);
+
+    ecs_admin_counter_add(&sched->coalesced, 1);
+
+    bool result = flight->result;
+    reply->status = flight->status;
+    reply->header = sched_strdup(flight->header);
+    reply->body = sched_strdup(flight->body);
+
+    ecs_os_mutex_lock(sched->lock);
+    sched_flight_t *to_free = release_flight(flight);
+    ecs_os_mutex_unlock(sched->lock);
+
+    if (to_free) {
+        free_flight(to_free);
+    }
+
+    return result;
+}
+
+/* Cheap reply for requests that could not be scheduled */
+static
+bool shed_request(
+    admin_sched_t *sched,
+    EcsHttpReply *reply)
+{
+    char header[64];
+    snprintf(header, sizeof(header), 
+        "Retry-After: %d\r\n", ADMIN_SCHED_RETRY_AFTER);
+
+    ecs_admin_counter_add(&sched->shed, 1);
+
+    reply->status = 503;
+    reply->header = sched_strdup(header);
+    reply->body = sched_strdup("{\"error\":\"too many requests\"}");
+
+    return true;
+}
+
+admin_sched_t* admin_sched_new(void)
+{
+    admin_sched_t *result = ecs_os_calloc(1, sizeof(admin_sched_t));
+    result->lock = ecs_os_mutex_new();
+    result->cond = ecs_os_cond_new();
+    result->flights = ecs_vector_new(&ptr_params, 0);
+    return result;
+}
+
+bool admin_sched_run(
+    admin_sched_t *sched,
+    const char *key,
+    admin_sched_action_t action,
+    void *ctx,
+    EcsHttpReply *reply)
+{
+    ecs_os_mutex_lock(sched->lock);
+
+    /* An identical request may take off while waiting for a slot, so check for
+     * in-flight requests each time the scheduler is woken up */
+    sched_flight_t *flight;
+    while (!(flight = find_flight(sched, key)) &&
+        sched->running >= ADMIN_SCHED_MAX_RUNNING)
+    {
+        if (sched->waiting >= ADMIN_SCHED_MAX_WAITING) {
+            ecs_os_mutex_unlock(sched->lock);
+            return shed_request(sched, reply);
+        }
+
+        sched->waiting ++;
+        ecs_os_cond_wait(sched->cond, sched->lock);
+        sched->waiting --;
+    }
+
+    if (flight) {
+        return join_flight(sched, flight, reply);
+    }
+
+    flight = ecs_os_calloc(1, sizeof(sched_flight_t));
+    flight->key = sched_strdup(key);
+    flight->refs = 1;
+    sched_flight_t **elem = ecs_vector_add(&sched->flights, &ptr_params);
+    *elem = flight;
+    sched->running ++;
+
+    ecs_os_mutex_unlock(sched->lock);
+
+    bool result = action(ctx, reply);
+
+    /* Requests can no longer join once the flight is removed, so the number of
+     * references does not grow after this point */
+    ecs_os_mutex_lock(sched->lock);
+    sched->running --;
+    remove_flight(sched, flight);
+    bool shared = flight->refs > 1;
+    ecs_os_mutex_unlock(sched->lock);
+
+    /* The reply of this request is owned by the HTTP server, so requests that
+     * joined share a single copy of it, made without the lock */
+    if (shared) {
+        flight->result = result;
+        flight->status = reply->status;
+        flight->header = sched_strdup(reply->header);
+        flight->body = sched_strdup(reply->body);
+    }
+
+    ecs_os_mutex_lock(sched->lock);
+    flight->done = true;
+    sched_flight_t *to_free = release_flight(flight);
+    ecs_os_cond_broadcast(sched->cond);
+    ecs_os_mutex_unlock(sched->lock);
+
+    if (to_free) {
+        free_flight(to_free);
+    }
+
+    return result;
+}
+
+ecs_admin_metric_t* admin_sched_shed(
+    admin_sched_t *sched)
+{
+    return &sched->shed;
+}
+
+ecs_admin_metric_t* admin_sched_coalesced(
+    admin_sched_t *sched)
+{
+    return &sched->coalesced;
+}
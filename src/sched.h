@@ -0,0 +1,46 @@
+#include <flecs_systems_admin.h>
+
+/* The request scheduler sits in front of endpoints that serialize statistics.
+ * Identical requests that arrive while a reply is being serialized wait for
+ * that reply instead of serializing their own (singleflight). The number of
+ * replies that are serialized at the same time is capped, so that dashboards
+ * cannot starve the simulation. Requests that arrive while all slots are taken
+ * wait for a slot, and when too many requests are waiting, new requests are
+ * shed with a 503 reply and a Retry-After header. */
+
+/* Maximum number of replies that are serialized at the same time */
+#define ADMIN_SCHED_MAX_RUNNING (4)
+
+/* Maximum number of requests that wait for a serialization slot */
+#define ADMIN_SCHED_MAX_WAITING (16)
+
+/* Seconds after which a client should retry a shed request */
+#define ADMIN_SCHED_RETRY_AFTER (1)
+
+typedef struct admin_sched_t admin_sched_t;
+
+/* Serialize reply. Same signature as an endpoint action, without endpoint. */
+typedef bool (*admin_sched_action_t)(
+    void *ctx,
+    EcsHttpReply *reply);
+
+admin_sched_t* admin_sched_new(void);
+
+/* Run action, or wait for the reply of an in-flight request with the same
+ * key. Requests with the same key must produce the same reply. The HTTP server
+ * frees the body of each reply, so requests that joined a flight share one
+ * copy of its reply, from which each gets its own body. Returns the result of
+ * the action, or true with a 503 reply if the request was shed. */
+bool admin_sched_run(
+    admin_sched_t *sched,
+    const char *key,
+    admin_sched_action_t action,
+    void *ctx,
+    EcsHttpReply *reply);
+
+/* Counters of shed and coalesced requests, which can be shown as metrics */
+ecs_admin_metric_t* admin_sched_shed(
+    admin_sched_t *sched);
+
+ecs_admin_metric_t* admin_sched_coalesced(
+    admin_sched_t *sched);
@@ -0,0 +1,207 @@
+#include <flecs_systems_admin.h>
+#include "series.h"
+
+static
+const ecs_vector_params_t double_params = {
+    .element_size = sizeof(double)
+};
+
+static
+const ecs_vector_params_t float_params = {
+    .element_size = sizeof(float)
+};
+
+static
+const ecs_vector_params_t* series_params(
+    admin_series_t *series)
+{
+    if (series->encoding == AdminEncodingDouble) {
+        return &double_params;
+    } else {
+        return &float_params;
+    }
+}
+
+/* Get sample at index as it is stored, without decoding deltas */
+static
+double series_get(
+    admin_series_t *series,
+    uint32_t index)
+{
+    void *elem = ecs_ringbuf_get(series->data, series_params(series), index);
+
+    if (series->encoding == AdminEncodingDouble) {
+        return *(double*)elem;
+    } else {
+        return *(float*)elem;
+    }
+}
+
+admin_series_t* admin_series_new(
+    admin_encoding_t encoding,
+    uint32_t size)
+{
+    admin_series_t *result = ecs_os_malloc(sizeof(admin_series_t));
+    result->encoding = encoding;
+    result->size = size;
+    result->first = 0;
+    result->last = 0;
+    result->data = ecs_ringbuf_new(series_params(result), size);
+    return result;
+}
+
+void admin_series_free(
+    admin_series_t *series)
+{
+    if (series) {
+        ecs_ringbuf_free(series->data);
+        ecs_os_free(series);
+    }
+}
+
+uint32_t admin_series_count(
+    admin_series_t *series)
+{
+    return ecs_ringbuf_count(series->data);
+}
+
+uint32_t admin_series_index(
+    admin_series_t *series)
+{
+    return ecs_ringbuf_index(series->data);
+}
+
+double admin_series_first(
+    admin_series_t *series)
+{
+    if (series->encoding == AdminEncodingDelta) {
+        return series->first;
+    } else {
+        return series_get(series, 0);
+    }
+}
+
+double admin_series_last(
+    admin_series_t *series)
+{
+    if (series->encoding == AdminEncodingDelta) {
+        return series->last;
+    } else {
+        void *elem = ecs_ringbuf_last(series->data, series_params(series));
+        if (series->encoding == AdminEncodingDouble) {
+            return *(double*)elem;
+        } else {
+            return *(float*)elem;
+        }
+    }
+}
+
+double admin_series_get(
+    admin_series_t *series,
+    uint32_t index)
+{
+    return series_get(series, index);
+}
+
+void admin_series_push(
+    admin_series_t *series,
+    double value)
+{
+    const ecs_vector_params_t *params = series_params(series);
+
+    if (series->encoding == AdminEncodingDouble) {
+        *(double*)ecs_ringbuf_push(series->data, params) = value;
+        return;
+    }
+
+    if (series->encoding == AdminEncodingFloat) {
+        *(float*)ecs_ringbuf_push(series->data, params) = value;
+        return;
+    }
+
+    uint32_t count = ecs_ringbuf_count(series->data);
+    if (!count) {
+        /* The delta of the oldest sample is never read, as the oldest sample
+         * is stored in first */
+        *(float*)ecs_ringbuf_push(series->data, params) = 0;
+        series->first = value;
+        series->last = value;
+        return;
+    }
+
+    /* When the oldest sample is overwritten, the next sample becomes the
+     * oldest, so decode it before its delta is no longer used */
+    if (count == series->size) {
+        series->first += series_get(series, 1);
+    }
+
+    float *elem = ecs_ringbuf_push(series->data, params);
+    *elem = value - series->last;
+    series->last += *elem;
+}
+
+void admin_series_set_last(
+    admin_series_t *series,
+    double value)
+{
+    const ecs_vector_params_t *params = series_params(series);
+
+    if (series->encoding == AdminEncodingDouble) {
+        *(double*)ecs_ringbuf_last(series->data, params) = value;
+        return;
+    }
+
+    float *elem = ecs_ringbuf_last(series->data, params);
+
+    if (series->encoding == AdminEncodingFloat) {
+        *elem = value;
+        return;
+    }
+
+    if (ecs_ringbuf_count(series->data) == 1) {
+        series->first = value;
+        series->last = value;
+        return;
+    }
+
+    double prev = series->last - *elem;
+    *elem = value - prev;
+    series->last = prev + *elem;
+}
+
+admin_series_iter_t admin_series_iter(
+    admin_series_t *series)
+{
+    return (admin_series_iter_t){
+        .series = series,
+        .count = ecs_ringbuf_count(series->data)
+    };
+}
+
+bool admin_series_next(
+    admin_series_iter_t *it)
+{
+    if (it->index == it->count) {
+        return false;
+    }
+
+    admin_series_t *series = it->series;
+
+    if (series->encoding != AdminEncodingDelta) {
+        it->value = series_get(series, it->index);
+    } else if (!it->index) {
+        it->value = series->first;
+    } else {
+        it->value += series_get(series, it->index);
+    }
+
+    it->index ++;
+
+    return true;
+}
+
+size_t admin_series_bytes(
+    admin_series_t *series)
+{
+    return series->size * series_params(series)->element_size;
+}
@@ -0,0 +1,84 @@
+#ifndef ADMIN_SERIES_H
+#define ADMIN_SERIES_H
+
+#include <flecs_systems_admin.h>
+
+/* Fixed size series of samples, stored in a ringbuffer. Samples can be stored
+ * in a compact encoding, which is decoded when the series is read. */
+
+typedef enum admin_encoding_t {
+    AdminEncodingDouble,    /* 8 bytes per sample, exact */
+    AdminEncodingFloat,     /* 4 bytes per sample, ~7 significant digits */
+    AdminEncodingDelta      /* 4 bytes per sample, difference with previous */
+} admin_encoding_t;
+
+/* A delta encoded series stores the difference with the previous sample as a
+ * float. The difference is computed against the decoded previous sample, so
+ * rounding errors do not accumulate. Differences of integer counters (like
+ * memory) are exact up to 2^24, which makes this encoding a good fit for
+ * slow-moving counters with large absolute values. */
+typedef struct admin_series_t {
+    ecs_ringbuf_t *data;
+    admin_encoding_t encoding;
+    uint32_t size;
+    double first;           /* Decoded oldest sample (delta encoding) */
+    double last;            /* Decoded newest sample (delta encoding) */
+} admin_series_t;
+
+/* Iterator over decoded samples, oldest first */
+typedef struct admin_series_iter_t {
+    admin_series_t *series;
+    uint32_t index;
+    uint32_t count;
+    double value;
+} admin_series_iter_t;
+
+admin_series_t* admin_series_new(
+    admin_encoding_t encoding,
+    uint32_t size);
+
+void admin_series_free(
+    admin_series_t *series);
+
+uint32_t admin_series_count(
+    admin_series_t *series);
+
+/* Position in ringbuffer at which the next sample is written */
+uint32_t admin_series_index(
+    admin_series_t *series);
+
+/* Get oldest sample. Series must not be empty. */
+double admin_series_first(
+    admin_series_t *series);
+
+/* Get newest sample. Series must not be empty. */
+double admin_series_last(
+    admin_series_t *series);
+
+/* Get sample at index, where 0 is the oldest sample. Samples of delta encoded
+ * series can only be read with an iterator. */
+double admin_series_get(
+    admin_series_t *series,
+    uint32_t index);
+
+/* Add sample, overwrites the oldest sample if the series is full */
+void admin_series_push(
+    admin_series_t *series,
+    double value);
+
+/* Replace newest sample. Series must not be empty. */
+void admin_series_set_last(
+    admin_series_t *series,
+    double value);
+
+admin_series_iter_t admin_series_iter(
+    admin_series_t *series);
+
+bool admin_series_next(
+    admin_series_iter_t *it);
+
+/* Number of bytes used to store samples */
+size_t admin_series_bytes(
+    admin_series_t *series);
+
+#endif
@@ -0,0 +1,507 @@
+#include <flecs_systems_admin.h>
+#include "server.h"
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+struct admin_server_t {
+    uint16_t port;
+
+    /* World that runs the HTTP server, NULL if that world was deleted */
+    ecs_world_t *owner;
+
+    /* Registered worlds (admin_world_t*) */
+    ecs_vector_t *worlds;
+
+    /* Schedules requests for statistics of all worlds of the server */
+    admin_sched_t *sched;
+};
+
+/* Request that waits for an action to run on the thread of a world */
+typedef struct admin_world_request_t {
+    admin_world_t *world;
+    admin_world_action_t action;
+    void *ctx;
+    bool result;
+    bool taken;         /* Removed from the queue by the world */
+    bool done;
+} admin_world_request_t;
+
+static
+const ecs_vector_params_t ptr_params = {
+    .element_size = sizeof(void*)
+};
+
+/* Servers (admin_server_t*) of all worlds in the process. Servers are not
+ * freed, as endpoints of a server may still be running when its last world is
+ * unregistered. */
+static ecs_vector_t *servers;
+static ecs_os_mutex_t registry_lock;
+static volatile int32_t registry_init;
+
+static
+bool registry_init_begin(void)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange((volatile LONG*)&registry_init, 1, 0) == 0;
+#else
+    int32_t expected = 0;
+    return __atomic_compare_exchange_n(
+        &registry_init, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static
+void registry_init_end(void)
+{
+#ifdef _MSC_VER
+    InterlockedExchange((volatile LONG*)&registry_init, 2);
+#else
+    __atomic_store_n(&registry_init, 2, __ATOMIC_RELEASE);
+#endif
+}
+
+static
+bool registry_ready(void)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange((volatile LONG*)&registry_init, 0, 0) == 2;
+#else
+    return __atomic_load_n(&registry_init, __ATOMIC_ACQUIRE) == 2;
+#endif
+}
+
+static
+void registry_yield(void)
+{
+#ifdef _MSC_VER
+    SwitchToThread();
+#else
+    struct timespec wait = {.tv_nsec = 1000};
+    nanosleep(&wait, NULL);
+#endif
+}
+
+/* Worlds can import the admin from different threads, so the registry lock is
+ * created by the first thread that gets to it, while other threads wait. This
+ * only happens once per process, and for as long as it takes to create the
+ * lock, so waiting threads yield instead of blocking. */
+static
+void registry_lock_init(void)
+{
+    if (registry_init_begin()) {
+        registry_lock = ecs_os_mutex_new();
+        registry_init_end();
+    } else {
+        while (!registry_ready()) {
+            registry_yield();
+        }
+    }
+}
+
+static
+admin_server_t* find_server(
+    uint16_t port)
+{
+    admin_server_t **buffer = ecs_vector_first(servers);
+    uint32_t i, count = ecs_vector_count(servers);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i]->port == port) {
+            return buffer[i];
+        }
+    }
+
+    return NULL;
+}
+
+static
+admin_world_t* find_world(
+    admin_server_t *server,
+    const char *name)
+{
+    admin_world_t **buffer = ecs_vector_first(server->worlds);
+    uint32_t i, count = ecs_vector_count(server->worlds);
+
+    for (i = 0; i < count; i ++) {
+        if (!strcmp(buffer[i]->name, name)) {
+            return buffer[i];
+        }
+    }
+
+    return NULL;
+}
+
+admin_server_t* admin_server_register(
+    uint16_t port,
+    const admin_world_t *world,
+    bool *is_owner_out)
+{
+    registry_lock_init();
+    ecs_os_mutex_lock(registry_lock);
+
+    if (!servers) {
+        servers = ecs_vector_new(&ptr_params, 1);
+    }
+
+    admin_server_t *server = find_server(port);
+    if (!server) {
+        server = ecs_os_calloc(1, sizeof(admin_server_t));
+        server->port = port;
+        server->worlds = ecs_vector_new(&ptr_params, 1);
+        server->sched = admin_sched_new();
+
+        admin_server_t **elem = ecs_vector_add(&servers, &ptr_params);
+        *elem = server;
+    }
+
+    if (find_world(server, world->name)) {
+        ecs_os_mutex_unlock(registry_lock);
+        return NULL;
+    }
+
+    admin_world_t *copy = ecs_os_malloc(sizeof(admin_world_t));
+    *copy = *world;
+    size_t name_len = strlen(world->name) + 1;
+    copy->name = ecs_os_malloc(name_len);
+    memcpy(copy->name, world->name, name_len);
+    copy->requests = ecs_vector_new(&ptr_params, 0);
+
+    admin_world_t **elem = ecs_vector_add(&server->worlds, &ptr_params);
+    *elem = copy;
+
+    if (!server->owner) {
+        server->owner = world->world;
+        *is_owner_out = true;
+    } else {
+        *is_owner_out = false;
+    }
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    return server;
+}
+
+uint32_t admin_server_unregister(
+    ecs_world_t *world)
+{
+    if (!registry_ready()) {
+        return 0;
+    }
+
+    ecs_vector_t *removed = ecs_vector_new(&ptr_params, 0);
+
+    ecs_os_mutex_lock(registry_lock);
+
+    admin_server_t **buffer = ecs_vector_first(servers);
+    uint32_t i, count = ecs_vector_count(servers);
+
+    for (i = 0; i < count; i ++) {
+        admin_server_t *server = buffer[i];
+        if (server->owner == world) {
+            server->owner = NULL;
+        }
+
+        uint32_t w = 0;
+        while (w < ecs_vector_count(server->worlds)) {
+            admin_world_t **worlds = ecs_vector_first(server->worlds);
+            if (worlds[w]->world == world) {
+                admin_world_t **elem = ecs_vector_add(&removed, &ptr_params);
+                *elem = worlds[w];
+                ecs_vector_remove_index(server->worlds, &ptr_params, w);
+            } else {
+                w ++;
+            }
+        }
+    }
+
+    /* Requests only run on the thread of the world, which is the thread that
+     * unregisters it, so no request is running. Requests that have not run yet
+     * complete without a result. */
+    admin_world_t **worlds = ecs_vector_first(removed);
+    count = ecs_vector_count(removed);
+
+    for (i = 0; i < count; i ++) {
+        admin_world_t *w = worlds[i];
+        admin_world_request_t **requests = ecs_vector_first(w->requests);
+        uint32_t r, request_count = ecs_vector_count(w->requests);
+        for (r = 0; r < request_count; r ++) {
+            requests[r]->done = true;
+        }
+    }
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    uint32_t tracking = 0;
+    for (i = 0; i < count; i ++) {
+        admin_world_t *w = worlds[i];
+        tracking += w->track_allocs;
+        ecs_vector_free(w->requests);
+        ecs_os_free(w->name);
+        ecs_os_free(w);
+    }
+
+    ecs_vector_free(removed);
+
+    return tracking;
+}
+
+/* Remove a request that the world has not taken yet */
+static
+void cancel_request(
+    admin_world_request_t *request)
+{
+    admin_world_t *world = request->world;
+    admin_world_request_t **requests = ecs_vector_first(world->requests);
+    uint32_t i, count = ecs_vector_count(world->requests);
+
+    for (i = 0; i < count; i ++) {
+        if (requests[i] == request) {
+            ecs_vector_remove_index(world->requests, &ptr_params, i);
+            break;
+        }
+    }
+}
+
+/* Post request to the world, and wait until it has run. Must be called while
+ * the registry lock is locked, and unlocks it. The OS API has no timed wait on
+ * a condition, so the waiting thread polls. A request that the world did not
+ * take within ADMIN_SERVER_TIMEOUT is cancelled. A request that the world has
+ * taken is running, and is always waited for, as it writes to the reply. */
+static
+admin_world_result_t post_request(
+    admin_world_t *world,
+    admin_world_action_t action,
+    void *ctx)
+{
+    admin_world_request_t request = {
+        .world = world,
+        .action = action,
+        .ctx = ctx
+    };
+
+    admin_world_request_t **elem = ecs_vector_add(
+        &world->requests, &ptr_params);
+    *elem = &request;
+
+    ecs_time_t start;
+    ecs_os_get_time(&start);
+    double waited = 0;
+
+    while (!request.done) {
+        if (!request.taken && waited >= ADMIN_SERVER_TIMEOUT) {
+            cancel_request(&request);
+            ecs_os_mutex_unlock(registry_lock);
+            return AdminWorldTimeout;
+        }
+
+        ecs_os_mutex_unlock(registry_lock);
+        ecs_os_sleep(0, ADMIN_SERVER_POLL_INTERVAL);
+        waited += ecs_time_measure(&start);
+        ecs_os_mutex_lock(registry_lock);
+    }
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    return request.result ? AdminWorldOk : AdminWorldFailed;
+}
+
+admin_world_result_t admin_server_run(
+    admin_server_t *server,
+    const char *name,
+    admin_world_action_t action,
+    void *ctx)
+{
+    ecs_os_mutex_lock(registry_lock);
+
+    admin_world_t *world = find_world(server, name);
+    if (!world) {
+        ecs_os_mutex_unlock(registry_lock);
+        return AdminWorldFailed;
+    }
+
+    return post_request(world, action, ctx);
+}
+
+admin_world_result_t admin_server_run_world(
+    ecs_world_t *world,
+    admin_world_action_t action,
+    void *ctx)
+{
+    if (!registry_ready()) {
+        return AdminWorldFailed;
+    }
+
+    ecs_os_mutex_lock(registry_lock);
+
+    admin_server_t **buffer = ecs_vector_first(servers);
+    uint32_t i, count = ecs_vector_count(servers);
+
+    for (i = 0; i < count; i ++) {
+        admin_world_t **worlds = ecs_vector_first(buffer[i]->worlds);
+        uint32_t w, world_count = ecs_vector_count(buffer[i]->worlds);
+
+        for (w = 0; w < world_count; w ++) {
+            if (worlds[w]->world == world) {
+                return post_request(worlds[w], action, ctx);
+            }
+        }
+    }
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    return AdminWorldFailed;
+}
+
+void admin_server_dispatch(
+    ecs_world_t *world)
+{
+    if (!registry_ready()) {
+        return;
+    }
+
+    ecs_vector_t *batch = NULL;
+
+    ecs_os_mutex_lock(registry_lock);
+
+    admin_server_t **buffer = ecs_vector_first(servers);
+    uint32_t i, count = ecs_vector_count(servers);
+
+    for (i = 0; i < count; i ++) {
+        admin_world_t **worlds = ecs_vector_first(buffer[i]->worlds);
+        uint32_t w, world_count = ecs_vector_count(buffer[i]->worlds);
+
+        for (w = 0; w < world_count; w ++) {
+            admin_world_t *registered = worlds[w];
+            if (registered->world != world || !ecs_vector_count(registered->requests)) {
+                continue;
+            }
+
+            if (!batch) {
+                batch = ecs_vector_new(&ptr_params, 0);
+            }
+
+            admin_world_request_t **requests = ecs_vector_first(registered->requests);
+            uint32_t r, request_count = ecs_vector_count(registered->requests);
+            for (r = 0; r < request_count; r ++) {
+                admin_world_request_t **elem = ecs_vector_add(
+                    &batch, &ptr_params);
+                *elem = requests[r];
+                requests[r]->taken = true;
+            }
+
+            ecs_vector_clear(registered->requests);
+        }
+    }
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    if (!batch) {
+        return;
+    }
+
+    /* Registered worlds are only freed by the thread of the world, so they can
+     * be accessed without the registry lock while requests run */
+    admin_world_request_t **requests = ecs_vector_first(batch);
+    count = ecs_vector_count(batch);
+
+    for (i = 0; i < count; i ++) {
+        admin_world_request_t *r = requests[i];
+        r->result = r->action(r->world, r->ctx);
+    }
+
+    ecs_os_mutex_lock(registry_lock);
+    for (i = 0; i < count; i ++) {
+        requests[i]->done = true;
+    }
+    ecs_os_mutex_unlock(registry_lock);
+
+    ecs_vector_free(batch);
+}
+
+/* Request for the summary of a single world */
+typedef struct summary_request_t {
+    ecs_strbuf_t *buf;
+    bool is_owner;
+} summary_request_t;
+
+static
+bool run_summary(
+    admin_world_t *world,
+    void *ctx)
+{
+    summary_request_t *r = ctx;
+    ecs_strbuf_t *buf = r->buf;
+
+    ecs_strbuf_list_next(buf);
+    ecs_strbuf_list_push(buf, "{", ",");
+    ecs_strbuf_list_append(buf, "\"name\":\"%s\"", world->name);
+    ecs_strbuf_list_append(buf, "\"is_owner\":%s", 
+        r->is_owner ? "true" : "false");
+    ecs_run(world->world, world->reply_summary, 0, buf);
+    ecs_strbuf_list_pop(buf, "}");
+
+    return true;
+}
+
+void admin_server_summary(
+    admin_server_t *server,
+    ecs_strbuf_t *buf)
+{
+    /* Copy the names of the worlds, as each world is summarized on its own
+     * thread, and worlds may be unregistered in the meantime */
+    ecs_vector_t *names = ecs_vector_new(&ptr_params, 0);
+    ecs_world_t *owner;
+
+    ecs_os_mutex_lock(registry_lock);
+
+    admin_world_t **worlds = ecs_vector_first(server->worlds);
+    uint32_t i, count = ecs_vector_count(server->worlds);
+
+    for (i = 0; i < count; i ++) {
+        size_t len = strlen(worlds[i]->name) + 1;
+        char **elem = ecs_vector_add(&names, &ptr_params);
+        *elem = ecs_os_malloc(len);
+        memcpy(*elem, worlds[i]->name, len);
+    }
+
+    owner = server->owner;
+
+    ecs_os_mutex_unlock(registry_lock);
+
+    ecs_strbuf_list_push(buf, "[", ",");
+
+    char **buffer = ecs_vector_first(names);
+    count = ecs_vector_count(names);
+
+    for (i = 0; i < count; i ++) {
+        summary_request_t r = {.buf = buf};
+
+        ecs_os_mutex_lock(registry_lock);
+        admin_world_t *world = find_world(server, buffer[i]);
+        if (world) {
+            r.is_owner = world->world == owner;
+            if (post_request(world, run_summary, &r) == AdminWorldTimeout) {
+                ecs_os_warn("admin: world '%s' did not reply", buffer[i]);
+            }
+        } else {
+            ecs_os_mutex_unlock(registry_lock);
+        }
+
+        ecs_os_free(buffer[i]);
+    }
+
+    ecs_strbuf_list_pop(buf, "]");
+
+    ecs_vector_free(names);
+}
+
+admin_sched_t* admin_server_sched(
+    admin_server_t *server)
+{
+    return server->sched;
+}
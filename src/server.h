@@ -0,0 +1,101 @@
+#include <flecs_systems_admin.h>
+#include "sched.h"
+
+/* An admin server can serve statistics of multiple worlds. Each world that has
+ * an EcsAdmin component registers itself with the server for its port. The
+ * first world that registers for a port owns the HTTP server, and other worlds
+ * are served by that server under worlds/<name>/.
+ *
+ * Statistics are still collected by each world on its own thread. A request for
+ * a world is posted to that world, and runs on the thread of the world once per
+ * frame, so that reply systems do not race with the systems of the world. Requests
+ * for different worlds do not block each other. A world that does not
+ * progress does not reply, and its requests time out. This includes the world
+ * that runs the HTTP server, as its endpoints run on HTTP threads. The registry
+ * lock only protects the list of worlds, and is not held while requests run. */
+
+/* World registered with an admin server */
+typedef struct admin_world_t {
+    char *name;
+    ecs_world_t *world;
+    ecs_vector_t *requests;     /* Requests that have not yet run */
+
+    /* Reply systems of the world */
+    ecs_entity_t reply;
+    ecs_entity_t reply_components;
+    ecs_entity_t reply_types;
+    ecs_entity_t reply_tables;
+    ecs_entity_t reply_summary;
+    ecs_entity_t reply_export;
+
+    uint64_t memory_limit;
+    bool track_allocs;          /* World enabled allocation tracking */
+} admin_world_t;
+
+typedef struct admin_server_t admin_server_t;
+
+/* Seconds a request waits for a world before it times out */
+#define ADMIN_SERVER_TIMEOUT (5.0)
+
+/* Nanoseconds between checks whether a request has run */
+#define ADMIN_SERVER_POLL_INTERVAL (1000000)
+
+/* Result of an action that is posted to a world */
+typedef enum admin_world_result_t {
+    AdminWorldFailed,       /* World not found, unregistered or action failed */
+    AdminWorldOk,
+    AdminWorldTimeout       /* World did not run the action in time */
+} admin_world_result_t;
+
+/* Action that runs on the thread of a world */
+typedef bool (*admin_world_action_t)(
+    admin_world_t *world,
+    void *ctx);
+
+/* Register world with the server for a port. The first world that registers
+ * for a port owns the server, in which case is_owner_out is set to true and the
+ * caller should start the HTTP server. Returns NULL if a world with the same
+ * name is already registered for the port. The server stores a copy of the
+ * world, and of its name. */
+admin_server_t* admin_server_register(
+    uint16_t port,
+    const admin_world_t *world,
+    bool *is_owner_out);
+
+/* Unregister world. Must be called from the thread of the world. Requests for
+ * the world that have not run yet return false. Returns the number of removed
+ * registrations that enabled allocation tracking. */
+uint32_t admin_server_unregister(
+    ecs_world_t *world);
+
+/* Run action on the thread of the world with the specified name, and wait until
+ * it has run. Returns AdminWorldTimeout if the world did not start the action
+ * within ADMIN_SERVER_TIMEOUT seconds, for example because it stopped
+ * progressing, in which case the action does not run. Must not be called from
+ * the thread of the world. */
+admin_world_result_t admin_server_run(
+    admin_server_t *server,
+    const char *name,
+    admin_world_action_t action,
+    void *ctx);
+
+/* Same as admin_server_run, for a world that is registered with any server */
+admin_world_result_t admin_server_run_world(
+    ecs_world_t *world,
+    admin_world_action_t action,
+    void *ctx);
+
+/* Run the actions that were posted for the world. Called once per frame from
+ * the thread of the world. */
+void admin_server_dispatch(
+    ecs_world_t *world);
+
+/* Write a summary of all worlds to the buffer. Each world writes its summary
+ * on its own thread. */
+void admin_server_summary(
+    admin_server_t *server,
+    ecs_strbuf_t *buf);
+
+/* Get request scheduler of the server */
+admin_sched_t* admin_server_sched(
+    admin_server_t *server);
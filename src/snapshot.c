@@ -0,0 +1,615 @@
+#include <flecs_systems_admin.h>
+#include "collect.h"
+#include "snapshot.h"
+#include "util.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Metrics that are stored in a snapshot, per kind */
+enum {
+    WorldFps,
+    WorldFrame,
+    WorldSystem,
+    WorldMerge,
+    WorldEntityRate,
+    WorldTableRate,
+    WorldComponentChurn,
+    WorldTableMatchRate,
+    WorldFrameOverhead
+};
+
+enum {
+    MemoryTotal,
+    MemoryEntities,
+    MemoryComponents,
+    MemorySystems,
+    MemoryTypes,
+    MemoryStages,
+    MemoryTables,
+    MemoryWorld
+};
+
+enum {
+    SystemTimeSpent,
+    SystemTimeSpentPct,
+    SystemTablesMatched,
+    SystemActivationRate
+};
+
+enum {
+    ComponentMemory,
+    ComponentEntityRate
+};
+
+static
+const char *kind_names[] = {
+    "world", "memory", "system", "component"
+};
+
+static
+const char *world_metrics[] = {
+    "fps", "frame", "system", "merge", "entity_rate", "table_rate",
+    "component_churn", "table_match_rate", "frame_overhead"
+};
+
+static
+const char *memory_metrics[] = {
+    "total", "entities", "components", "systems", "types", "stages", "tables",
+    "world"
+};
+
+static
+const char *system_metrics[] = {
+    "time_spent", "time_spent_pct", "tables_matched", "activation_rate"
+};
+
+static
+const char *component_metrics[] = {
+    "memory", "entity_rate"
+};
+
+static
+const ecs_vector_params_t entry_params = {
+    .element_size = sizeof(admin_snapshot_entry_t)
+};
+
+static
+const char* metric_name(
+    uint16_t kind,
+    uint16_t metric)
+{
+    switch(kind) {
+    case AdminSnapshotWorld: return world_metrics[metric];
+    case AdminSnapshotMemory: return memory_metrics[metric];
+    case AdminSnapshotSystem: return system_metrics[metric];
+    case AdminSnapshotComponent: return component_metrics[metric];
+    default: return "";
+    }
+}
+
+static
+double avg_1m(
+    admin_stat_t *stat)
+{
+    if (!stat->data_1m || !admin_series_count(stat->data_1m)) {
+        return stat->current;
+    }
+
+    admin_series_iter_t it = admin_series_iter(stat->data_1m);
+    double sum = 0;
+    while (admin_series_next(&it)) {
+        sum += it.value;
+    }
+
+    return sum / it.count;
+}
+
+static
+void add_entry(
+    admin_snapshot_t *snapshot,
+    ecs_entity_t entity,
+    uint16_t kind,
+    uint16_t metric,
+    admin_stat_t *stat)
+{
+    admin_snapshot_entry_t *entry = ecs_vector_add(
+        &snapshot->entries, &entry_params);
+
+    entry->entity = entity;
+    entry->kind = kind;
+    entry->metric = metric;
+    entry->current = stat->current;
+    entry->avg_1m = avg_1m(stat);
+}
+
+static
+void AdminSnapshotWorldStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, AdminWorldStats, admin_stats, 1);
+
+    admin_snapshot_t *snapshot = rows->param;
+
+    uint16_t k = AdminSnapshotWorld;
+    add_entry(snapshot, 0, k, WorldFps, &admin_stats->fps);
+    add_entry(snapshot, 0, k, WorldFrame, &admin_stats->frame);
+    add_entry(snapshot, 0, k, WorldSystem, &admin_stats->system);
+    add_entry(snapshot, 0, k, WorldMerge, &admin_stats->merge);
+    add_entry(snapshot, 0, k, WorldEntityRate, &admin_stats->entity_rate);
+    add_entry(snapshot, 0, k, WorldTableRate, &admin_stats->table_rate);
+    add_entry(snapshot, 0, k, WorldComponentChurn, &admin_stats->component_churn);
+    add_entry(snapshot, 0, k, WorldTableMatchRate, &admin_stats->table_match_rate);
+    add_entry(snapshot, 0, k, WorldFrameOverhead, &admin_stats->frame_overhead);
+}
+
+static
+void AdminSnapshotMemoryStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, AdminMemoryStats, admin_stats, 1);
+
+    admin_snapshot_t *snapshot = rows->param;
+
+    uint16_t k = AdminSnapshotMemory;
+    add_entry(snapshot, 0, k, MemoryTotal, &admin_stats->total.used);
+    add_entry(snapshot, 0, k, MemoryEntities, &admin_stats->entities.used);
+    add_entry(snapshot, 0, k, MemoryComponents, &admin_stats->components.used);
+    add_entry(snapshot, 0, k, MemorySystems, &admin_stats->systems.used);
+    add_entry(snapshot, 0, k, MemoryTypes, &admin_stats->types.used);
+    add_entry(snapshot, 0, k, MemoryStages, &admin_stats->stages.used);
+    add_entry(snapshot, 0, k, MemoryTables, &admin_stats->tables.used);
+    add_entry(snapshot, 0, k, MemoryWorld, &admin_stats->world.used);
+}
+
+static
+void AdminSnapshotSystemStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsSystemStats, stats, 1);
+    ECS_COLUMN(rows, AdminSystemStats, admin_stats, 2);
+
+    admin_snapshot_t *snapshot = rows->param;
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_entity_t e = stats[i].entity;
+        uint16_t k = AdminSnapshotSystem;
+        add_entry(snapshot, e, k, SystemTimeSpent, &admin_stats[i].time_spent);
+        add_entry(snapshot, e, k, SystemTimeSpentPct, &admin_stats[i].time_spent_pct);
+        add_entry(snapshot, e, k, SystemTablesMatched, &admin_stats[i].tables_matched);
+        add_entry(snapshot, e, k, SystemActivationRate, &admin_stats[i].activation_rate);
+    }
+}
+
+static
+void AdminSnapshotComponentStats(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, EcsComponentStats, stats, 1);
+    ECS_COLUMN(rows, AdminComponentStats, admin_stats, 2);
+
+    admin_snapshot_t *snapshot = rows->param;
+
+    uint32_t i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_entity_t e = stats[i].entity;
+        uint16_t k = AdminSnapshotComponent;
+        add_entry(snapshot, e, k, ComponentMemory, &admin_stats[i].memory.used);
+        add_entry(snapshot, e, k, ComponentEntityRate, &admin_stats[i].entity_rate);
+    }
+}
+
+static
+int compare_entries(
+    const void *p1,
+    const void *p2)
+{
+    const admin_snapshot_entry_t *e1 = p1;
+    const admin_snapshot_entry_t *e2 = p2;
+
+    if (e1->kind != e2->kind) {
+        return e1->kind - e2->kind;
+    }
+
+    if (e1->entity != e2->entity) {
+        return e1->entity < e2->entity ? -1 : 1;
+    }
+
+    return e1->metric - e2->metric;
+}
+
+static
+void AdminSnapshotCapture(ecs_rows_t *rows) {
+    ECS_COLUMN_ENTITY(rows, AdminSnapshotWorldStats, 1);
+    ECS_COLUMN_ENTITY(rows, AdminSnapshotMemoryStats, 2);
+    ECS_COLUMN_ENTITY(rows, AdminSnapshotSystemStats, 3);
+    ECS_COLUMN_ENTITY(rows, AdminSnapshotComponentStats, 4);
+
+    ecs_world_t *world = rows->world;
+    admin_snapshot_t *snapshot = rows->param;
+
+    ecs_run(world, AdminSnapshotWorldStats, 0, snapshot);
+    ecs_run(world, AdminSnapshotMemoryStats, 0, snapshot);
+    ecs_run(world, AdminSnapshotSystemStats, 0, snapshot);
+    ecs_run(world, AdminSnapshotComponentStats, 0, snapshot);
+
+    /* Sort entries, so that snapshots can be compared with a single pass */
+    qsort(ecs_vector_first(snapshot->entries), 
+        ecs_vector_count(snapshot->entries), 
+        sizeof(admin_snapshot_entry_t), compare_entries);
+}
+
+admin_snapshot_store_t* admin_snapshot_store_new(
+    ecs_entity_t capture_system)
+{
+    admin_snapshot_store_t *result = ecs_os_calloc(
+        1, sizeof(admin_snapshot_store_t));
+    result->capture_system = capture_system;
+    return result;
+}
+
+admin_snapshot_t* admin_snapshot_capture(
+    ecs_world_t *world,
+    admin_snapshot_store_t *store,
+    const char *name)
+{
+    admin_snapshot_t *result = ecs_os_malloc(sizeof(admin_snapshot_t));
+    strncpy(result->name, name, ADMIN_SNAPSHOT_NAME_SIZE - 1);
+    result->name[ADMIN_SNAPSHOT_NAME_SIZE - 1] = '\0';
+    result->entries = ecs_vector_new(&entry_params, 0);
+
+    ecs_time_t now;
+    ecs_os_get_time(&now);
+    result->time = ecs_time_to_double(now);
+
+    ecs_run(world, store->capture_system, 0, result);
+
+    return result;
+}
+
+void admin_snapshot_free(
+    admin_snapshot_t *snapshot)
+{
+    ecs_vector_free(snapshot->entries);
+    ecs_os_free(snapshot);
+}
+
+static
+int32_t find_index(
+    admin_snapshot_store_t *store,
+    const char *name)
+{
+    int32_t i;
+    for (i = 0; i < ADMIN_SNAPSHOT_MAX; i ++) {
+        admin_snapshot_t *snapshot = store->snapshots[i];
+        if (snapshot && !strcmp(snapshot->name, name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool admin_snapshot_store(
+    admin_snapshot_store_t *store,
+    admin_snapshot_t *snapshot)
+{
+    int32_t i = find_index(store, snapshot->name);
+    if (i != -1) {
+        admin_snapshot_free(store->snapshots[i]);
+        store->snapshots[i] = snapshot;
+        return true;
+    }
+
+    for (i = 0; i < ADMIN_SNAPSHOT_MAX; i ++) {
+        if (!store->snapshots[i]) {
+            store->snapshots[i] = snapshot;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+admin_snapshot_t* admin_snapshot_find(
+    admin_snapshot_store_t *store,
+    const char *name)
+{
+    int32_t i = find_index(store, name);
+    if (i == -1) {
+        return NULL;
+    }
+
+    return store->snapshots[i];
+}
+
+bool admin_snapshot_remove(
+    admin_snapshot_store_t *store,
+    const char *name)
+{
+    int32_t i = find_index(store, name);
+    if (i == -1) {
+        return false;
+    }
+
+    admin_snapshot_free(store->snapshots[i]);
+    store->snapshots[i] = NULL;
+
+    return true;
+}
+
+void admin_snapshot_list(
+    admin_snapshot_store_t *store,
+    ecs_strbuf_t *buf)
+{
+    ecs_time_t now;
+    ecs_os_get_time(&now);
+    double now_sec = ecs_time_to_double(now);
+
+    ecs_strbuf_list_push(buf, "[", ",");
+
+    int32_t i;
+    for (i = 0; i < ADMIN_SNAPSHOT_MAX; i ++) {
+        admin_snapshot_t *snapshot = store->snapshots[i];
+        if (!snapshot) {
+            continue;
+        }
+
+        ecs_strbuf_list_next(buf);
+        ecs_strbuf_list_push(buf, "{", ",");
+        ecs_strbuf_list_append(buf, "\"name\":\"%s\"", snapshot->name);
+        ecs_strbuf_list_append(buf, "\"age\":%f", now_sec - snapshot->time);
+        ecs_strbuf_list_append(buf, "\"entry_count\":%u",
+            ecs_vector_count(snapshot->entries));
+        ecs_strbuf_list_pop(buf, "}");
+    }
+
+    ecs_strbuf_list_pop(buf, "]");
+}
+
+/* Difference between the entries of two snapshots. Metrics that only exist in
+ * one of the snapshots (for example because a system was created after the
+ * baseline was taken) are compared against 0. */
+typedef struct admin_diff_t {
+    admin_snapshot_entry_t *from;
+    admin_snapshot_entry_t *to;
+    double delta;
+    double relative;
+} admin_diff_t;
+
+static
+const ecs_vector_params_t diff_params = {
+    .element_size = sizeof(admin_diff_t)
+};
+
+static
+void add_diff(
+    ecs_vector_t **diffs,
+    admin_snapshot_entry_t *from,
+    admin_snapshot_entry_t *to,
+    admin_diff_params_t *params)
+{
+    admin_snapshot_entry_t *e = from ? from : to;
+    if (params->kind != -1 && e->kind != params->kind) {
+        return;
+    }
+
+    double from_value = from ? from->avg_1m : 0;
+    double to_value = to ? to->avg_1m : 0;
+    double delta = to_value - from_value;
+
+    /* Unchanged metrics are not interesting, and would only make the list
+     * longer */
+    if (delta == 0) {
+        return;
+    }
+
+    admin_diff_t *diff = ecs_vector_add(diffs, &diff_params);
+    diff->from = from;
+    diff->to = to;
+    diff->delta = delta;
+
+    if (from_value) {
+        diff->relative = delta / fabs(from_value);
+    } else {
+        diff->relative = INFINITY;
+    }
+}
+
+static
+void write_value(
+    ecs_strbuf_t *buf,
+    const char *member,
+    admin_snapshot_entry_t *e)
+{
+    if (e) {
+        ecs_strbuf_list_append(buf, "\"%s\":{\"current\":%f,\"avg_1m\":%f}",
+            member, e->current, e->avg_1m);
+    } else {
+        ecs_strbuf_list_append(buf, "\"%s\":null", member);
+    }
+}
+
+static
+void write_diff(
+    ecs_world_t *world,
+    admin_diff_t *diff,
+    ecs_strbuf_t *buf)
+{
+    admin_snapshot_entry_t *e = diff->from ? diff->from : diff->to;
+
+    ecs_strbuf_list_next(buf);
+    ecs_strbuf_list_push(buf, "{", ",");
+    ecs_strbuf_list_append(buf, "\"kind\":\"%s\"", kind_names[e->kind]);
+
+    if (e->entity) {
+        const char *id = ecs_get_id(world, e->entity);
+        if (id) {
+            ecs_strbuf_list_append(buf, "\"name\":\"%s\"", id);
+        } else {
+            ecs_strbuf_list_append(buf, "\"name\":\"%u\"", (uint32_t)e->entity);
+        }
+    }
+
+    ecs_strbuf_list_append(buf, "\"metric\":\"%s\"",
+        metric_name(e->kind, e->metric));
+    write_value(buf, "from", diff->from);
+    write_value(buf, "to", diff->to);
+    ecs_strbuf_list_append(buf, "\"delta\":%f", diff->delta);
+
+    if (isinf(diff->relative)) {
+        ecs_strbuf_list_appendstr(buf, "\"relative\":null");
+    } else {
+        ecs_strbuf_list_append(buf, "\"relative\":%f", diff->relative);
+    }
+
+    ecs_strbuf_list_pop(buf, "}");
+}
+
+void admin_snapshot_diff(
+    ecs_world_t *world,
+    admin_snapshot_t *from,
+    admin_snapshot_t *to,
+    admin_diff_params_t *params,
+    ecs_strbuf_t *buf)
+{
+    admin_snapshot_entry_t *from_entries = ecs_vector_first(from->entries);
+    admin_snapshot_entry_t *to_entries = ecs_vector_first(to->entries);
+    uint32_t from_count = ecs_vector_count(from->entries);
+    uint32_t to_count = ecs_vector_count(to->entries);
+    ecs_vector_t *diffs = ecs_vector_new(&diff_params, 0);
+
+    /* Merge the sorted entries of both snapshots */
+    uint32_t f = 0, t = 0;
+    while (f < from_count || t < to_count) {
+        int cmp;
+        if (f == from_count) {
+            cmp = 1;
+        } else if (t == to_count) {
+            cmp = -1;
+        } else {
+            cmp = compare_entries(&from_entries[f], &to_entries[t]);
+        }
+
+        if (!cmp) {
+            add_diff(&diffs, &from_entries[f ++], &to_entries[t ++], params);
+        } else if (cmp < 0) {
+            add_diff(&diffs, &from_entries[f ++], NULL, params);
+        } else {
+            add_diff(&diffs, NULL, &to_entries[t ++], params);
+        }
+    }
+
+    admin_diff_t *buffer = ecs_vector_first(diffs);
+    uint32_t i, count = ecs_vector_count(diffs);
+
+    /* A relative change from zero is infinite, and its absolute change cannot
+     * be compared with the relative change of other metrics. When sorting by
+     * relative change, metrics that were zero in the baseline are therefore
+     * listed first, as a separate group that is ordered by absolute change. */
+    uint32_t added_count = 0;
+    if (params->relative) {
+        for (i = 0; i < count; i ++) {
+            if (isinf(buffer[i].relative)) {
+                added_count ++;
+            }
+        }
+    }
+
+    /* The page is split between both groups */
+    uint32_t cursor = params->cursor, limit = params->limit;
+    uint32_t added_page = 0;
+    if (cursor < added_count) {
+        added_page = added_count - cursor;
+        if (limit && added_page > limit) {
+            added_page = limit;
+        }
+    }
+
+    admin_select_t added, changed;
+    admin_select_init(&added, &(admin_page_t){
+        .limit = limit,
+        .cursor = cursor
+    });
+    admin_select_init(&changed, &(admin_page_t){
+        .limit = limit ? limit - added_page : 0,
+        .cursor = cursor > added_count ? cursor - added_count : 0
+    });
+
+    for (i = 0; i < count; i ++) {
+        admin_snapshot_entry_t *e = buffer[i].from
+            ? buffer[i].from : buffer[i].to;
+
+        if (!params->relative || isinf(buffer[i].relative)) {
+            admin_select_t *group = params->relative ? &added : &changed;
+            admin_select_add(group, fabs(buffer[i].delta), e->entity, 
+                &buffer[i], NULL);
+        } else {
+            admin_select_add(&changed, fabs(buffer[i].relative), e->entity, 
+                &buffer[i], NULL);
+        }
+    }
+
+    uint32_t added_page_count = 0, changed_page_count = 0;
+    admin_select_elem_t *added_elems = admin_select_page(
+        &added, &added_page_count);
+
+    /* A limit of 0 selects all, so only select changes if the page has room */
+    admin_select_elem_t *changed_elems = NULL;
+    if (!limit || added_page_count < limit) {
+        changed_elems = admin_select_page(&changed, &changed_page_count);
+    }
+
+    uint32_t page_count = added_page_count + changed_page_count;
+
+    ecs_strbuf_list_push(buf, "{", ",");
+    ecs_strbuf_list_append(buf, "\"from\":\"%s\"", from->name);
+    ecs_strbuf_list_append(buf, "\"to\":\"%s\"", to->name);
+    ecs_strbuf_list_append(buf, "\"count\":%u", count);
+    ecs_strbuf_list_append(buf, "\"added_count\":%u", added_count);
+    ecs_strbuf_list_appendstr(buf, "\"diffs\":");
+    ecs_strbuf_list_push(buf, "[", ",");
+    for (i = 0; i < added_page_count; i ++) {
+        write_diff(world, added_elems[i].stats, buf);
+    }
+    for (i = 0; i < changed_page_count; i ++) {
+        write_diff(world, changed_elems[i].stats, buf);
+    }
+    ecs_strbuf_list_pop(buf, "]");
+
+    if (params->cursor + page_count < count) {
+        ecs_strbuf_list_append(buf, "\"next_cursor\":%u",
+            params->cursor + page_count);
+    } else {
+        ecs_strbuf_list_appendstr(buf, "\"next_cursor\":null");
+    }
+
+    ecs_strbuf_list_pop(buf, "}");
+
+    admin_select_deinit(&added);
+    admin_select_deinit(&changed);
+    ecs_vector_free(diffs);
+}
+
+void AdminSnapshotImport(
+    ecs_world_t *world,
+    int flags)
+{
+    ECS_MODULE(world, AdminSnapshot);
+
+    /* Add statistics to snapshot that is passed as param */
+    ECS_SYSTEM(world, AdminSnapshotWorldStats, EcsManual, [in] AdminWorldStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminSnapshotMemoryStats, EcsManual, [in] AdminMemoryStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminSnapshotSystemStats, EcsManual, [in] EcsSystemStats, [in] AdminSystemStats,
+        SYSTEM.EcsHidden);
+
+    ECS_SYSTEM(world, AdminSnapshotComponentStats, EcsManual, [in] EcsComponentStats, [in] AdminComponentStats,
+        SYSTEM.EcsHidden);
+
+    /* Capture all statistics into a snapshot */
+    ECS_SYSTEM(world, AdminSnapshotCapture, EcsManual,
+        .AdminSnapshotWorldStats,
+        .AdminSnapshotMemoryStats,
+        .AdminSnapshotSystemStats,
+        .AdminSnapshotComponentStats,
+        SYSTEM.EcsHidden);
+
+    ECS_EXPORT_ENTITY(AdminSnapshotCapture);
+}
@@ -0,0 +1,100 @@
+#include <flecs_systems_admin.h>
+
+/* The AdminSnapshot module captures named baselines of the admin statistics, so
+ * that statistics can be compared before and after a change. A snapshot stores
+ * the current value and the average of the last minute of each metric, for the
+ * world, memory, systems and components. */
+
+/* Maximum number of snapshots that are stored at the same time */
+#define ADMIN_SNAPSHOT_MAX (16)
+
+/* Maximum length of a snapshot name, including the terminating 0 */
+#define ADMIN_SNAPSHOT_NAME_SIZE (64)
+
+typedef enum admin_snapshot_kind_t {
+    AdminSnapshotWorld,
+    AdminSnapshotMemory,
+    AdminSnapshotSystem,
+    AdminSnapshotComponent
+} admin_snapshot_kind_t;
+
+/* Single metric in a snapshot. Values are stored as float to keep snapshots
+ * small, as the precision is sufficient for comparing measurements. */
+typedef struct admin_snapshot_entry_t {
+    ecs_entity_t entity;
+    uint16_t kind;
+    uint16_t metric;
+    float current;
+    float avg_1m;
+} admin_snapshot_entry_t;
+
+typedef struct admin_snapshot_t {
+    char name[ADMIN_SNAPSHOT_NAME_SIZE];
+    double time;            /* Time at which the snapshot was taken */
+    ecs_vector_t *entries;  /* Entries, ordered by kind, entity and metric */
+} admin_snapshot_t;
+
+/* Named snapshots of a world */
+typedef struct admin_snapshot_store_t {
+    ecs_entity_t capture_system;
+    admin_snapshot_t *snapshots[ADMIN_SNAPSHOT_MAX];
+} admin_snapshot_store_t;
+
+/* Parameters for a diff between two snapshots */
+typedef struct admin_diff_params_t {
+    bool relative;          /* Sort by relative instead of absolute change */
+    int32_t kind;           /* Only diff metrics of kind, -1 for all kinds */
+    uint32_t limit;
+    uint32_t cursor;
+} admin_diff_params_t;
+
+admin_snapshot_store_t* admin_snapshot_store_new(
+    ecs_entity_t capture_system);
+
+/* Capture snapshot of the current statistics. The snapshot is not stored. */
+admin_snapshot_t* admin_snapshot_capture(
+    ecs_world_t *world,
+    admin_snapshot_store_t *store,
+    const char *name);
+
+void admin_snapshot_free(
+    admin_snapshot_t *snapshot);
+
+/* Store snapshot under its name, replacing an existing snapshot with the same
+ * name. Returns false if the store is full. */
+bool admin_snapshot_store(
+    admin_snapshot_store_t *store,
+    admin_snapshot_t *snapshot);
+
+admin_snapshot_t* admin_snapshot_find(
+    admin_snapshot_store_t *store,
+    const char *name);
+
+/* Remove snapshot from the store. Returns false if it does not exist. */
+bool admin_snapshot_remove(
+    admin_snapshot_store_t *store,
+    const char *name);
+
+/* Write list of stored snapshots */
+void admin_snapshot_list(
+    admin_snapshot_store_t *store,
+    ecs_strbuf_t *buf);
+
+/* Write differences between two snapshots, largest changes first */
+void admin_snapshot_diff(
+    ecs_world_t *world,
+    admin_snapshot_t *from,
+    admin_snapshot_t *to,
+    admin_diff_params_t *params,
+    ecs_strbuf_t *buf);
+
+typedef struct AdminSnapshot {
+    ECS_DECLARE_ENTITY(AdminSnapshotCapture);
+} AdminSnapshot;
+
+void AdminSnapshotImport(
+    ecs_world_t *world,
+    int flags);
+
+#define AdminSnapshotImportHandles(handles) \
+    ECS_IMPORT_ENTITY(handles, AdminSnapshotCapture);
@@ -0,0 +1,378 @@
+#include <flecs_systems_admin.h>
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+static
+const ecs_vector_params_t select_elem_params = {
+    .element_size = sizeof(admin_select_elem_t)
+};
+
+void admin_select_init(
+    admin_select_t *select,
+    admin_page_t *page)
+{
+    select->page = *page;
+    select->elems = ecs_vector_new(&select_elem_params, 0);
+}
+
+void admin_select_deinit(
+    admin_select_t *select)
+{
+    ecs_vector_free(select->elems);
+    select->elems = NULL;
+}
+
+void admin_select_add(
+    admin_select_t *select,
+    double key,
+    ecs_entity_t entity,
+    void *stats,
+    void *admin_stats)
+{
+    admin_select_elem_t *elem = ecs_vector_add(
+        &select->elems, &select_elem_params);
+
+    elem->key = key;
+    elem->entity = entity;
+    elem->stats = stats;
+    elem->admin_stats = admin_stats;
+}
+
+uint32_t admin_select_count(
+    admin_select_t *select)
+{
+    return ecs_vector_count(select->elems);
+}
+
+/* Returns true if element a should appear before element b. Elements with equal
+ * keys are ordered by entity id, so that pages are stable between requests. */
+static
+bool elem_before(
+    admin_select_elem_t *a,
+    admin_select_elem_t *b)
+{
+    if (a->key != b->key) {
+        return a->key > b->key;
+    }
+
+    return a->entity < b->entity;
+}
+
+/* Restore heap property for a heap where the root is the element that should
+ * appear last of all elements in the heap. */
+static
+void heap_sift_down(
+    admin_select_elem_t *heap,
+    uint32_t count,
+    uint32_t index)
+{
+    while (true) {
+        uint32_t child = index * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+
+        if (child + 1 < count && elem_before(&heap[child], &heap[child + 1])) {
+            child ++;
+        }
+
+        if (!elem_before(&heap[index], &heap[child])) {
+            break;
+        }
+
+        admin_select_elem_t tmp = heap[index];
+        heap[index] = heap[child];
+        heap[child] = tmp;
+        index = child;
+    }
+}
+
+/* Move the k elements that appear first to the start of the array, in sorted
+ * order. This keeps a bounded heap of size k, which is O(n log k) as opposed to
+ * O(n log n) for sorting the entire array. */
+static
+void select_top(
+    admin_select_elem_t *elems,
+    uint32_t count,
+    uint32_t k)
+{
+    if (k > count) {
+        k = count;
+    }
+
+    if (!k) {
+        return;
+    }
+
+    int32_t i;
+    for (i = k / 2 - 1; i >= 0; i --) {
+        heap_sift_down(elems, k, i);
+    }
+
+    uint32_t j;
+    for (j = k; j < count; j ++) {
+        if (elem_before(&elems[j], &elems[0])) {
+            admin_select_elem_t tmp = elems[0];
+            elems[0] = elems[j];
+            elems[j] = tmp;
+            heap_sift_down(elems, k, 0);
+        }
+    }
+
+    /* Heap sort the selected elements. The root of the heap is the element that
+     * should appear last, so moving it to the end yields the right order. */
+    for (j = k - 1; j > 0; j --) {
+        admin_select_elem_t tmp = elems[0];
+        elems[0] = elems[j];
+        elems[j] = tmp;
+        heap_sift_down(elems, j, 0);
+    }
+}
+
+admin_select_elem_t* admin_select_page(
+    admin_select_t *select,
+    uint32_t *count_out)
+{
+    admin_select_elem_t *elems = ecs_vector_first(select->elems);
+    uint32_t count = ecs_vector_count(select->elems);
+    uint32_t cursor = select->page.cursor;
+    uint32_t limit = select->page.limit;
+
+    if (cursor >= count) {
+        *count_out = 0;
+        return NULL;
+    }
+
+    if (!limit || limit > count - cursor) {
+        limit = count - cursor;
+    }
+
+    select_top(elems, count, cursor + limit);
+
+    *count_out = limit;
+
+    return &elems[cursor];
+}
+
+bool admin_http_param(
+    const char *params,
+    const char *name,
+    char *buf,
+    size_t size)
+{
+    if (!params) {
+        return false;
+    }
+
+    size_t name_len = strlen(name);
+    const char *ptr = params;
+
+    while (ptr && *ptr) {
+        const char *end = strchr(ptr, '&');
+        size_t len = end ? (size_t)(end - ptr) : strlen(ptr);
+
+        if (len > name_len && ptr[name_len] == '=' &&
+            !strncmp(ptr, name, name_len))
+        {
+            size_t value_len = len - name_len - 1;
+            if (value_len >= size) {
+                return false;
+            }
+
+            memcpy(buf, &ptr[name_len + 1], value_len);
+            buf[value_len] = '\0';
+            return true;
+        }
+
+        ptr = end ? end + 1 : NULL;
+    }
+
+    return false;
+}
+
+bool admin_http_param_uint(
+    const char *params,
+    const char *name,
+    uint32_t *value_out)
+{
+    char buf[32];
+    if (!admin_http_param(params, name, buf, sizeof(buf))) {
+        return false;
+    }
+
+    char *end;
+    unsigned long value = strtoul(buf, &end, 10);
+    if (end == buf || *end) {
+        return false;
+    }
+
+    *value_out = value;
+    return true;
+}
+
+static
+bool parse_sort(
+    const char *str,
+    admin_sort_t *sort_out)
+{
+    if (!strcmp(str, "memory")) {
+        *sort_out = AdminSortMemory;
+    } else if (!strcmp(str, "entities")) {
+        *sort_out = AdminSortEntities;
+    } else if (!strcmp(str, "tables")) {
+        *sort_out = AdminSortTables;
+    } else if (!strcmp(str, "components")) {
+        *sort_out = AdminSortComponents;
+    } else if (!strcmp(str, "systems")) {
+        *sort_out = AdminSortSystems;
+    } else if (!strcmp(str, "waste")) {
+        *sort_out = AdminSortWaste;
+    } else if (!strcmp(str, "churn")) {
+        *sort_out = AdminSortChurn;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+bool admin_parse_page(
+    const char *params,
+    const char *prefix,
+    admin_page_t *page)
+{
+    char name[64], value[32];
+
+    snprintf(name, sizeof(name), "%ssort", prefix);
+    if (admin_http_param(params, name, value, sizeof(value))) {
+        if (!parse_sort(value, &page->sort)) {
+            return false;
+        }
+    }
+
+    snprintf(name, sizeof(name), "%slimit", prefix);
+    if (admin_http_param(params, name, value, sizeof(value))) {
+        if (!admin_http_param_uint(params, name, &page->limit)) {
+            return false;
+        }
+    }
+
+    snprintf(name, sizeof(name), "%scursor", prefix);
+    if (admin_http_param(params, name, value, sizeof(value))) {
+        if (!admin_http_param_uint(params, name, &page->cursor)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void admin_flag_set(
+    volatile int32_t *flag)
+{
+#ifdef _MSC_VER
+    InterlockedExchange((volatile LONG*)flag, 1);
+#else
+    __atomic_store_n(flag, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+bool admin_flag_get(
+    volatile int32_t *flag)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange((volatile LONG*)flag, 0, 0) != 0;
+#else
+    return __atomic_load_n(flag, __ATOMIC_RELAXED) != 0;
+#endif
+}
+
+double admin_unix_time(void)
+{
+#ifdef _MSC_VER
+    /* FILETIME counts 100ns intervals since 1601 */
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (double)(t - 116444736000000000ULL) / 10000000.0;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+#endif
+}
+
+void admin_append_json_string(
+    ecs_strbuf_t *buf,
+    const char *str)
+{
+    if (!str) {
+        str = "";
+    }
+
+    ecs_strbuf_appendstrn(buf, "\"", 1);
+
+    const char *ptr, *run = str;
+    for (ptr = str; *ptr; ptr ++) {
+        unsigned char ch = *ptr;
+        if (ch != '"' && ch != '\\' && ch >= 0x20) {
+            continue;
+        }
+
+        /* Write unescaped characters up to the one that is escaped */
+        if (ptr != run) {
+            ecs_strbuf_appendstrn(buf, run, ptr - run);
+        }
+        run = ptr + 1;
+
+        switch (ch) {
+        case '"': ecs_strbuf_appendstrn(buf, "\\\"", 2); break;
+        case '\\': ecs_strbuf_appendstrn(buf, "\\\\", 2); break;
+        case '\n': ecs_strbuf_appendstrn(buf, "\\n", 2); break;
+        case '\r': ecs_strbuf_appendstrn(buf, "\\r", 2); break;
+        case '\t': ecs_strbuf_appendstrn(buf, "\\t", 2); break;
+        default: ecs_strbuf_append(buf, "\\u%04x", ch); break;
+        }
+    }
+
+    if (ptr != run) {
+        ecs_strbuf_appendstrn(buf, run, ptr - run);
+    }
+
+    ecs_strbuf_appendstrn(buf, "\"", 1);
+}
+
+void admin_append_csv_field(
+    ecs_strbuf_t *buf,
+    const char *str)
+{
+    if (!str) {
+        return;
+    }
+
+    if (!strpbrk(str, ",\"\r\n")) {
+        ecs_strbuf_appendstr(buf, str);
+        return;
+    }
+
+    /* Quote the field, and double quotes in the field */
+    ecs_strbuf_appendstrn(buf, "\"", 1);
+
+    const char *run = str, *quote;
+    while ((quote = strchr(run, '"'))) {
+        ecs_strbuf_appendstrn(buf, run, quote - run + 1);
+        ecs_strbuf_appendstrn(buf, "\"", 1);
+        run = quote + 1;
+    }
+
+    ecs_strbuf_appendstr(buf, run);
+    ecs_strbuf_appendstrn(buf, "\"", 1);
+}
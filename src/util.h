@@ -0,0 +1,115 @@
+#ifndef ADMIN_UTIL_H
+#define ADMIN_UTIL_H
+
+#include <flecs_systems_admin.h>
+
+/* Utilities that are shared between the admin modules, such as selecting a
+ * sorted page from a (potentially large) list and parsing request parameters */
+
+/* Keys by which the admin can sort lists of entities */
+typedef enum admin_sort_t {
+    AdminSortMemory,
+    AdminSortEntities,
+    AdminSortTables,
+    AdminSortComponents,
+    AdminSortSystems,
+    AdminSortWaste,
+    AdminSortChurn
+} admin_sort_t;
+
+/* Selects a page from a sorted list. A limit of 0 selects all elements after
+ * the cursor. The cursor is the number of elements to skip. */
+typedef struct admin_page_t {
+    admin_sort_t sort;
+    uint32_t limit;
+    uint32_t cursor;
+} admin_page_t;
+
+/* Element in a list from which a page is selected. The stats pointers point to
+ * the component data of the entity, and are only valid while the reply is being
+ * constructed. */
+typedef struct admin_select_elem_t {
+    double key;
+    ecs_entity_t entity;
+    void *stats;
+    void *admin_stats;
+} admin_select_elem_t;
+
+/* Selection that is passed as parameter to systems that collect elements */
+typedef struct admin_select_t {
+    admin_page_t page;
+    ecs_vector_t *elems;
+} admin_select_t;
+
+void admin_select_init(
+    admin_select_t *select,
+    admin_page_t *page);
+
+void admin_select_deinit(
+    admin_select_t *select);
+
+void admin_select_add(
+    admin_select_t *select,
+    double key,
+    ecs_entity_t entity,
+    void *stats,
+    void *admin_stats);
+
+/* Returns the number of elements that were added to the selection */
+uint32_t admin_select_count(
+    admin_select_t *select);
+
+/* Sort the elements on the page, and return the first element of the page. The
+ * number of elements on the page is returned in count_out. Elements outside of
+ * the page are only partially sorted, which is a lot cheaper than sorting all
+ * elements when the page is small compared to the list. */
+admin_select_elem_t* admin_select_page(
+    admin_select_t *select,
+    uint32_t *count_out);
+
+/* Find value of parameter in query string (a=1&b=2). Returns false if the
+ * parameter could not be found or does not fit in the provided buffer. */
+bool admin_http_param(
+    const char *params,
+    const char *name,
+    char *buf,
+    size_t size);
+
+/* Same as admin_http_param, but parses value as unsigned integer */
+bool admin_http_param_uint(
+    const char *params,
+    const char *name,
+    uint32_t *value_out);
+
+/* Set a flag that is read by another thread */
+void admin_flag_set(
+    volatile int32_t *flag);
+
+/* Read a flag that is set by another thread */
+bool admin_flag_get(
+    volatile int32_t *flag);
+
+/* Current unix time in seconds, with sub-second resolution */
+double admin_unix_time(void);
+
+/* Parse sort, limit and cursor parameters into page. Parameter names are
+ * prefixed with prefix, so multiple pages can be specified in one request.
+ * Returns false if a parameter has an invalid value. */
+bool admin_parse_page(
+    const char *params,
+    const char *prefix,
+    admin_page_t *page);
+
+/* Append str as a quoted JSON string. Names that are set by the application
+ * may contain any character, so they are escaped before they are written. */
+void admin_append_json_string(
+    ecs_strbuf_t *buf,
+    const char *str);
+
+/* Append str as a CSV field, quoted only when it contains a separator, quote
+ * or line break */
+void admin_append_csv_field(
+    ecs_strbuf_t *buf,
+    const char *str);
+
+#endif